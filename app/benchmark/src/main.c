@@ -0,0 +1,343 @@
+#include <stdlib.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <lvgl.h>
+
+#include "trend.h"
+
+#ifdef CONFIG_EMUL_MB7040
+#include <zephyr/drivers/emul.h>
+#include <app/drivers/sensor/emul_mb7040.h>
+#endif
+
+/*
+ * Every metric is printed as one line:
+ *   BENCH {"metric":"<name>","unit":"<unit>",...}
+ * so runs can be collected with `grep ^BENCH` and compared between firmware versions.
+ */
+
+#define SENSOR_DEV(node_id) DEVICE_DT_GET(node_id),
+static const struct device *const sensors[] = {
+    DT_FOREACH_STATUS_OKAY(maxbotix_mb7040, SENSOR_DEV)
+};
+
+#ifdef CONFIG_EMUL_MB7040
+#define SENSOR_EMUL(node_id) EMUL_DT_GET(node_id),
+static const struct emul *const emuls[] = {
+    DT_FOREACH_STATUS_OKAY(maxbotix_mb7040, SENSOR_EMUL)
+};
+#endif
+
+#define NUM_SENSORS ARRAY_SIZE(sensors)
+
+static uint32_t results_us[CONFIG_BENCH_SAMPLES];
+
+static lv_obj_t *label;
+static lv_obj_t *bar;
+static lv_obj_t *chart;
+static lv_chart_series_t *series;
+static lv_chart_series_t *series_min;
+static lv_chart_series_t *series_max;
+
+// Updated from the display's flush finished event, after the driver took the last area
+static volatile uint32_t flush_done_cycles;
+static volatile uint32_t flush_count;
+
+static inline uint32_t elapsed_us(uint32_t start_cycles)
+{
+    return k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void report_percentiles(const char *metric, uint32_t *values, size_t count)
+{
+    if (count == 0) {
+        printk("BENCH {\"metric\":\"%s\",\"unit\":\"us\",\"n\":0}\n", metric);
+        return;
+    }
+
+    qsort(values, count, sizeof(values[0]), cmp_u32);
+
+    printk("BENCH {\"metric\":\"%s\",\"unit\":\"us\",\"n\":%u,\"min\":%u,\"p50\":%u,"
+           "\"p90\":%u,\"p99\":%u,\"max\":%u}\n",
+           metric, (unsigned int)count, values[0], values[count / 2],
+           values[count * 90 / 100], values[count * 99 / 100], values[count - 1]);
+}
+
+// value_milli is printed with three decimals
+static void report_value(const char *metric, const char *unit, int sensor, uint64_t value_milli)
+{
+    printk("BENCH {\"metric\":\"%s\",\"unit\":\"%s\",\"sensor\":%d,\"value\":%u.%03u}\n",
+           metric, unit, sensor, (unsigned int)(value_milli / 1000),
+           (unsigned int)(value_milli % 1000));
+}
+
+// Start a measurement and wait until its sample can be read
+static int fetch_blocking(const struct device *dev, struct sensor_value *val)
+{
+    int ret;
+
+    ret = sensor_sample_fetch(dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    do {
+        ret = sensor_channel_get(dev, SENSOR_CHAN_DISTANCE, val);
+        if (ret == -EAGAIN) {
+            k_usleep(200);
+        }
+    } while (ret == -EAGAIN);
+
+    return ret;
+}
+
+static void bench_fetch_latency(void)
+{
+    struct sensor_value val;
+    size_t count = 0;
+
+    for (int i = 0; i < CONFIG_BENCH_SAMPLES; i++) {
+        uint32_t start = k_cycle_get_32();
+
+        if (fetch_blocking(sensors[0], &val) == 0) {
+            results_us[count++] = elapsed_us(start);
+        }
+    }
+
+    report_percentiles("fetch_latency", results_us, count);
+}
+
+static void bench_throughput(void)
+{
+    uint32_t samples[NUM_SENSORS] = {0};
+    uint32_t errors[NUM_SENSORS] = {0};
+    bool busy[NUM_SENSORS] = {false};
+    uint32_t total = 0;
+    struct sensor_value val;
+    int ret;
+    int64_t start = k_uptime_get();
+    int64_t elapsed;
+#ifdef CONFIG_EMUL_MB7040
+    uint32_t bytes_before = 0;
+    uint32_t bytes = 0;
+
+    for (size_t i = 0; i < NUM_SENSORS; i++) {
+        bytes_before += mb7040_emul_get_bus_bytes(emuls[i]);
+    }
+#endif
+
+    // Keep every sensor ranging as fast as the driver lets it
+    while (k_uptime_get() - start < CONFIG_BENCH_THROUGHPUT_MS) {
+        for (size_t i = 0; i < NUM_SENSORS; i++) {
+            if (!busy[i]) {
+                busy[i] = sensor_sample_fetch(sensors[i]) == 0;
+                continue;
+            }
+
+            ret = sensor_channel_get(sensors[i], SENSOR_CHAN_DISTANCE, &val);
+            if (ret == -EAGAIN) {
+                continue;
+            }
+            // A failed cycle frees the sensor but is no sample
+            if (ret == 0) {
+                samples[i]++;
+            } else {
+                errors[i]++;
+            }
+            busy[i] = false;
+        }
+        k_usleep(200);
+    }
+
+    elapsed = k_uptime_get() - start;
+
+    for (size_t i = 0; i < NUM_SENSORS; i++) {
+        report_value("samples_per_s", "Hz", i, (uint64_t)samples[i] * 1000000 / elapsed);
+        report_value("cycle_errors", "", i, (uint64_t)errors[i] * 1000);
+        total += samples[i];
+    }
+    report_value("samples_per_s_aggregate", "Hz", -1, (uint64_t)total * 1000000 / elapsed);
+
+#ifdef CONFIG_EMUL_MB7040
+    for (size_t i = 0; i < NUM_SENSORS; i++) {
+        bytes += mb7040_emul_get_bus_bytes(emuls[i]);
+    }
+    if (total > 0) {
+        report_value("i2c_bytes_per_sample", "B", -1,
+                     (uint64_t)(bytes - bytes_before) * 1000 / total);
+    }
+#endif
+}
+
+static void flush_finish_cb(lv_event_t *e)
+{
+    ARG_UNUSED(e);
+
+    flush_done_cycles = k_cycle_get_32();
+    flush_count++;
+}
+
+/*
+ * Render and flush whatever the last widget update invalidated, right now instead of whenever
+ * the refresh timer is due. Returns false if nothing was drawn, otherwise end_cycles is when the
+ * last area was flushed.
+ */
+static bool render_flush(uint32_t *end_cycles)
+{
+    uint32_t flushes = flush_count;
+
+    lv_refr_now(NULL);
+    *end_cycles = flush_done_cycles;
+
+    return flush_count != flushes;
+}
+
+static void bench_ui_init(void)
+{
+    lv_display_add_event_cb(lv_display_get_default(), flush_finish_cb, LV_EVENT_FLUSH_FINISH,
+                            NULL);
+
+    label = lv_label_create(lv_screen_active());
+    lv_obj_align(label, LV_ALIGN_CENTER, 0, 80);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_18, 0);
+
+    bar = lv_bar_create(lv_screen_active());
+    lv_bar_set_range(bar, 0, 765);
+    lv_obj_set_size(bar, 400, 30);
+    lv_obj_align(bar, LV_ALIGN_CENTER, 0, 40);
+
+    chart = lv_chart_create(lv_screen_active());
+    lv_obj_set_size(chart, 400, 120);
+    lv_obj_align(chart, LV_ALIGN_TOP_MID, 0, 10);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, 765);
+    lv_chart_set_point_count(chart, CONFIG_APP_TREND_POINTS);
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+    series_min = lv_chart_add_series(chart, lv_palette_lighten(LV_PALETTE_GREY, 2),
+                                     LV_CHART_AXIS_PRIMARY_Y);
+    series_max = lv_chart_add_series(chart, lv_palette_lighten(LV_PALETTE_GREY, 2),
+                                     LV_CHART_AXIS_PRIMARY_Y);
+    series = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+
+    // Chart on the raw trend ring, as distance_display shows it at its default zoom
+    trend_init();
+    lv_chart_set_ext_y_array(chart, series, trend_get(TREND_RAW)->mean);
+    lv_chart_set_ext_y_array(chart, series_min, trend_get(TREND_RAW)->min);
+    lv_chart_set_ext_y_array(chart, series_max, trend_get(TREND_RAW)->max);
+    lv_chart_hide_series(chart, series_min, true);
+    lv_chart_hide_series(chart, series_max, true);
+}
+
+// Same widget updates distance_display does for a new sample: the sample goes into the trend
+// rings and the chart series are repointed at the new ring head
+static void bench_ui_update(int cm)
+{
+    const struct trend_ring *ring;
+
+    lv_label_set_text_fmt(label, "%d cm", cm);
+    lv_bar_set_value(bar, cm, LV_ANIM_OFF);
+
+    trend_add(cm, k_uptime_get());
+    ring = trend_get(TREND_RAW);
+    lv_chart_set_x_start_point(chart, series, ring->head);
+    lv_chart_set_x_start_point(chart, series_min, ring->head);
+    lv_chart_set_x_start_point(chart, series_max, ring->head);
+    lv_chart_refresh(chart);
+}
+
+static void bench_lvgl(void)
+{
+    size_t count = 0;
+
+    for (int i = 0; i < CONFIG_BENCH_SAMPLES; i++) {
+        uint32_t start, end;
+
+        // Every value differs from the last one, so every update redraws something
+        bench_ui_update(i % 765);
+        start = k_cycle_get_32();
+        if (render_flush(&end)) {
+            results_us[count++] = k_cyc_to_us_floor32(end - start);
+        }
+    }
+
+    report_percentiles("render_flush", results_us, count);
+}
+
+static void bench_end_to_end(void)
+{
+    struct sensor_value val;
+    size_t count = 0;
+
+    for (int i = 0; i < CONFIG_BENCH_SAMPLES; i++) {
+        uint32_t start, end;
+
+#ifdef CONFIG_EMUL_MB7040
+        // The target moves, latency runs until the new distance is flushed to the panel
+        mb7040_emul_set_distance(emuls[0], 20 + (i * 37) % 700);
+#endif
+        start = k_cycle_get_32();
+
+        if (fetch_blocking(sensors[0], &val) != 0) {
+            continue;
+        }
+        bench_ui_update(val.val1 * 100 + val.val2 / 10000);
+        if (!render_flush(&end)) {
+            continue;
+        }
+
+        results_us[count++] = k_cyc_to_us_floor32(end - start);
+    }
+
+    report_percentiles("sensor_to_display", results_us, count);
+}
+
+int main(void)
+{
+    const struct device *display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+    for (size_t i = 0; i < NUM_SENSORS; i++) {
+        if (!device_is_ready(sensors[i])) {
+            printk("Sensor %s not ready\n", sensors[i]->name);
+            return -1;
+        }
+    }
+
+    if (!device_is_ready(display_dev)) {
+        printk("Display not ready\n");
+        return -1;
+    }
+
+#ifdef CONFIG_EMUL_MB7040
+    for (size_t i = 0; i < NUM_SENSORS; i++) {
+        mb7040_emul_set_distance(emuls[i], 100 + 50 * i);
+    }
+#endif
+
+    bench_ui_init();
+    lv_timer_handler();
+    display_blanking_off(display_dev);
+
+    printk("BENCH {\"metric\":\"config\",\"sensors\":%u,\"samples\":%d,\"board\":\"%s\"}\n",
+           (unsigned int)NUM_SENSORS, CONFIG_BENCH_SAMPLES, CONFIG_BOARD_TARGET);
+
+    bench_fetch_latency();
+    bench_throughput();
+    bench_lvgl();
+    bench_end_to_end();
+
+    printk("BENCH {\"metric\":\"done\"}\n");
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "layout.h"
+
+#include <zephyr/sys/__assert.h>
+
+static lv_obj_t *layout_create(enum layout_type type, lv_obj_t *parent)
+{
+    switch (type) {
+    case LAYOUT_LABEL:
+        return lv_label_create(parent);
+    case LAYOUT_BUTTON:
+        return lv_button_create(parent);
+    case LAYOUT_SWITCH:
+        return lv_switch_create(parent);
+    case LAYOUT_BAR:
+        return lv_bar_create(parent);
+    case LAYOUT_CHART:
+        return lv_chart_create(parent);
+    case LAYOUT_OBJ:
+    default:
+        return lv_obj_create(parent);
+    }
+}
+
+void layout_build(lv_obj_t *screen, const struct layout_node *nodes, size_t count,
+                  lv_obj_t **objs)
+{
+    for (size_t i = 0; i < count; i++) {
+        const struct layout_node *node = &nodes[i];
+        lv_obj_t *obj;
+
+        // Only the nodes before this one exist yet
+        __ASSERT(node->parent <= i && node->align_to <= i,
+                 "layout node %u refers to a later node", (unsigned int)i);
+
+        obj = layout_create(node->type, node->parent ? objs[node->parent - 1] : screen);
+        objs[i] = obj;
+        if (node->obj != NULL) {
+            *node->obj = obj;
+        }
+
+        if (node->bare) {
+            lv_obj_remove_style_all(obj);
+        }
+        for (int s = 0; s < LAYOUT_MAX_STYLES && node->styles[s].style != NULL; s++) {
+            lv_obj_add_style(obj, node->styles[s].style, node->styles[s].selector);
+        }
+        if (node->w != 0) {
+            lv_obj_set_width(obj, node->w);
+        }
+        if (node->h != 0) {
+            lv_obj_set_height(obj, node->h);
+        }
+        if (node->text != NULL) {
+            lv_label_set_text_static(obj, node->text);
+        }
+        if (node->state != 0) {
+            lv_obj_add_state(obj, node->state);
+        }
+        if (node->clear_flags != 0) {
+            lv_obj_remove_flag(obj, node->clear_flags);
+        }
+        if (node->event_cb != NULL) {
+            lv_obj_add_event_cb(obj, node->event_cb, node->event, NULL);
+        }
+        if (node->setup != NULL) {
+            node->setup(obj);
+        }
+
+        // The size, text and font are final by now, so aligning to this node works
+        if (node->align_to != 0) {
+            lv_obj_align_to(obj, objs[node->align_to - 1], node->align, node->x, node->y);
+        } else {
+            lv_obj_align(obj, node->align, node->x, node->y);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef DISTANCE_DISPLAY_LAYOUT_H_
+#define DISTANCE_DISPLAY_LAYOUT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lvgl.h>
+#include <zephyr/devicetree.h>
+
+// Layouts are drawn for a 480x320 panel and scaled to the zephyr,display resolution at compile
+// time
+#define LAYOUT_W DT_PROP(DT_CHOSEN(zephyr_display), width)
+#define LAYOUT_H DT_PROP(DT_CHOSEN(zephyr_display), height)
+#define LAYOUT_X(v) ((v) * LAYOUT_W / 480)
+#define LAYOUT_Y(v) ((v) * LAYOUT_H / 320)
+
+// Reference to an earlier node of the same table. 0 refers to the screen.
+#define LAYOUT_REF(node) ((node) + 1)
+
+#define LAYOUT_MAX_STYLES 3
+
+enum layout_type {
+    LAYOUT_OBJ,
+    LAYOUT_LABEL,
+    LAYOUT_BUTTON,
+    LAYOUT_SWITCH,
+    LAYOUT_BAR,
+    LAYOUT_CHART,
+};
+
+struct layout_style {
+    const lv_style_t *style;
+    lv_style_selector_t selector;
+};
+
+struct layout_node {
+    enum layout_type type;
+    // Where to keep the created object, NULL if nothing needs it after the build
+    lv_obj_t **obj;
+    // LAYOUT_REF() of the parent, 0 for the screen
+    uint8_t parent;
+    // LAYOUT_REF() of the node to align to, 0 to align within the parent
+    uint8_t align_to;
+    lv_align_t align;
+    int16_t x;
+    int16_t y;
+    // 0 keeps the widget's own size
+    int16_t w;
+    int16_t h;
+    // Label text, not copied
+    const char *text;
+    // Drop the theme's styles, for plain containers
+    bool bare;
+    lv_state_t state;
+    lv_obj_flag_t clear_flags;
+    // Shared styles, the list ends at the first NULL style
+    struct layout_style styles[LAYOUT_MAX_STYLES];
+    lv_event_cb_t event_cb;
+    lv_event_code_t event;
+    // Widget specific setup that doesn't fit the table, runs before the node is aligned
+    void (*setup)(lv_obj_t *obj);
+};
+
+// Create all nodes on screen in a single pass, in table order. objs has room for count objects
+// and holds them once done.
+void layout_build(lv_obj_t *screen, const struct layout_node *nodes, size_t count,
+                  lv_obj_t **objs);
+
+#endif
@@ -11,18 +11,28 @@
 #include <zephyr/sys/printk.h>    
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/sensor.h> 
+#include <app/drivers/sensor/mb7040.h>
+
+#include "layout.h"
+#include "point_store.h"
+#include "theme.h"
+#include "trend.h"
+#include "units.h"
 
 LOG_MODULE_REGISTER(distance_display, LOG_LEVEL_INF);
 
+// The sensor thread drains the driver's stream ring directly
+BUILD_ASSERT(IS_ENABLED(CONFIG_MB7040_STREAM), "distance_display needs CONFIG_MB7040_STREAM");
+
 
 #define MAX_VALUE 765
 #define MIN_VALUE 0
-#define MAX_POINTS 50
 
 static lv_obj_t *history_screen;
 static lv_obj_t *main_screen;
 
 static lv_obj_t *label;
+static lv_obj_t *velocity_label;
 static lv_obj_t *sw;
 static lv_obj_t *cm_label;
 static lv_obj_t *inch_label;
@@ -32,392 +42,436 @@ static lv_obj_t *chart;
 static lv_obj_t *pause_btn;
 static lv_obj_t *darkMode_btn;
 
-static lv_style_t default_style;
 static lv_chart_series_t *series;
-static bool chart_paused;
-static struct sensor_value sensor_val;
-static lv_style_t style_bar_indic;
-static bool use_cm;
+// Bucket min and max, only shown when zoomed out
+static lv_chart_series_t *series_min;
+static lv_chart_series_t *series_max;
+static lv_obj_t *zoom_btn;
+static lv_obj_t *zoom_label;
+static enum trend_level chart_zoom;
+// Written by the UI, read by the sensor thread
+static volatile bool chart_paused;
+// Latest distance shown on screen, in cm
+static int current_cm;
+// Latest velocity from the driver, in cm/s, negative while the target approaches
+static int current_cm_per_s;
+static enum distance_unit display_unit;
 
 static bool is_dark_mode;
-static lv_style_t dark_bg_style;
-static lv_style_t light_bg_style;
-static lv_style_t dark_btn_style;
-static lv_style_t light_btn_style;
-static lv_style_t dark_label_style;
-static lv_style_t light_label_style;
-
-static int saved_points[MAX_POINTS];
-static int saved_count = 0;
+
 static lv_obj_t *save_btn;
 static lv_obj_t *history_btn;
 static lv_obj_t *hist_title;
-static lv_obj_t *point_label;
 
 
-void history_points(void);
+struct distance_sample {
+    int64_t timestamp_ms;
+    int cm;
+    int cm_per_s;
+};
 
-static int update_distance(const struct device *sensor_dev)
-{
-    int ret;
-    char buf[8];
+K_MSGQ_DEFINE(sample_msgq, sizeof(struct distance_sample), CONFIG_APP_SAMPLE_QUEUE_LEN, 4);
 
-    ret = sensor_sample_fetch(sensor_dev);
-    if (ret != 0) {
-        printk("ERROR: Failed to fetch sample: %d\n", ret);
-        return ret;
-    }
+void history_points(void);
 
-    do {
-        ret = sensor_channel_get(sensor_dev, SENSOR_CHAN_DISTANCE, &sensor_val);
-        if (ret == -EAGAIN) {
-            k_msleep(5);
-        }
-    } while (ret == -EAGAIN);
+// Given by the pause button when ranging should resume
+static K_SEM_DEFINE(resume_sem, 0, 1);
 
-    if (ret != 0) {
-        printk("ERROR: Failed to get channel: %d\n", ret);
-        return ret;
-    }
-    // Convert to total centimeters from meters + micro-meters
-    int total_cm = sensor_val.val1 * 100 + sensor_val.val2 / 10000;
+static void sensor_thread(void *p1, void *p2, void *p3)
+{
+    const struct device *sensor_dev = p1;
+    struct mb7040_sample batch[CONFIG_APP_SAMPLE_QUEUE_LEN];
+    struct sensor_value sensor_val;
+    struct distance_sample sample;
+    int cm_per_s = 0;
+    size_t count;
 
-    // Clamp value if needed
-    if (total_cm < MIN_VALUE) total_cm = MIN_VALUE;
-    if (total_cm > MAX_VALUE) total_cm = MAX_VALUE;
+    // The driver ranges in the background, this thread only drains what it measured
+    mb7040_stream_start(sensor_dev);
 
-    // Print distance
+    while (1) {
+        if (chart_paused) {
+            // Stop ranging altogether, the sensor and the bus stay quiet until resumed
+            mb7040_stream_stop(sensor_dev);
+            while (chart_paused) {
+                k_sem_take(&resume_sem, K_FOREVER);
+            }
+            mb7040_stream_start(sensor_dev);
+        }
 
-    if (use_cm){
-        // LOG_INF("Distance in cm: %d", total_cm);
+        k_msleep(CONFIG_APP_UI_PERIOD_MS);
 
-        lv_snprintf(buf, sizeof(buf), "%d cm", total_cm);
-    } else{
-        //convert cm to inches 
-        int inches = total_cm / 2.54;
-        // LOG_INF("Distance in inches: %d", inches);
+        count = mb7040_stream_read(sensor_dev, batch, ARRAY_SIZE(batch));
+        if (count == 0) {
+            continue;
+        }
 
-        lv_snprintf(buf, sizeof(buf), "%d ''", inches);
+#ifdef CONFIG_MB7040_VELOCITY
+        // Filtered by the driver from the sample timestamps, as of the newest sample
+        if (sensor_channel_get(sensor_dev, (enum sensor_channel)SENSOR_CHAN_MB7040_VELOCITY,
+                               &sensor_val) == 0) {
+            cm_per_s = sensor_val.val1;
+        }
+#else
+        ARG_UNUSED(sensor_val);
+#endif
+
+        for (size_t i = 0; i < count; i++) {
+            if (batch[i].status & MB7040_SAMPLE_ERROR) {
+                printk("ERROR: Range cycle failed\n");
+                continue;
+            }
+
+            sample.cm = batch[i].distance_cm;
+            sample.timestamp_ms = batch[i].timestamp_ns / NSEC_PER_MSEC;
+            sample.cm_per_s = cm_per_s;
+
+            // Clamp value if needed
+            if (sample.cm < MIN_VALUE) sample.cm = MIN_VALUE;
+            if (sample.cm > MAX_VALUE) sample.cm = MAX_VALUE;
+
+            while (k_msgq_put(&sample_msgq, &sample, K_NO_WAIT) != 0) {
+                // UI fell behind, drop the oldest sample to make room
+                struct distance_sample dropped;
+
+                k_msgq_get(&sample_msgq, &dropped, K_NO_WAIT);
+            }
+        }
     }
-
-    lv_chart_set_next_value(chart, series, total_cm);
-
-        // Update LVGL UI
-    lv_label_set_text(label, buf);
-    lv_bar_set_value(bar, total_cm, LV_ANIM_ON);
-
-
-    return 0;
 }
 
-static void sw_event_cb(lv_event_t * e){
-    lv_obj_t * sw = lv_event_get_target_obj(e);
+K_THREAD_STACK_DEFINE(sensor_stack, CONFIG_APP_SENSOR_THREAD_STACK_SIZE);
+static struct k_thread sensor_thread_data;
+
+// What is currently on screen. Widgets are only touched when the visible output would change.
+static struct {
+    bool valid;
+    int label_value;     // number shown in the label, in the unit below
+    enum distance_unit label_unit;
+    int velocity_value;  // number shown in the velocity label, in label_unit per second
+    int bar_cm;
+    // Trend level the chart series point at and the ring version last drawn
+    enum trend_level chart_level;
+    uint32_t chart_version;
+} view;
+
+static void update_distance(int total_cm, int cm_per_s, int64_t timestamp_ms)
+{
+    current_cm = total_cm;
+    current_cm_per_s = cm_per_s;
 
-    if (lv_obj_has_state(sw, LV_STATE_CHECKED)) {
-        use_cm = true;
-    } else {
-        use_cm = false;
-    }
+    // Written straight into the rings the chart draws from
+    trend_add(total_cm, timestamp_ms);
 }
 
+static void chart_show_level(enum trend_level level)
+{
+    const struct trend_ring *ring = trend_get(level);
 
-void init_styles(void) {
-    // Backgrounds
-    lv_style_init(&dark_bg_style);
-    lv_style_set_bg_color(&dark_bg_style, lv_color_hex(0x121212));
-    lv_style_set_bg_opa(&dark_bg_style, LV_OPA_COVER);
-
-    lv_style_init(&light_bg_style);
-    lv_style_set_bg_color(&light_bg_style, lv_color_hex(0xf0f0f0));
-    lv_style_set_bg_opa(&light_bg_style, LV_OPA_COVER);
-
-    // Buttons
-    lv_style_init(&dark_btn_style);
-    lv_style_set_bg_color(&dark_btn_style, lv_palette_main(LV_PALETTE_GREY));
-    lv_style_set_text_color(&dark_btn_style, lv_color_white());
-
-    lv_style_init(&light_btn_style);
-    lv_style_set_bg_color(&light_btn_style, lv_palette_main(LV_PALETTE_LIGHT_BLUE));
-    lv_style_set_text_color(&light_btn_style, lv_color_black());
-
-    // Labels
-    lv_style_init(&dark_label_style);
-    lv_style_set_text_color(&dark_label_style, lv_color_white());
+    // The series draw from the trend rings directly, zooming copies nothing
+    lv_chart_set_ext_y_array(chart, series, ring->mean);
+    lv_chart_set_ext_y_array(chart, series_min, ring->min);
+    lv_chart_set_ext_y_array(chart, series_max, ring->max);
+    lv_chart_hide_series(chart, series_min, level == TREND_RAW);
+    lv_chart_hide_series(chart, series_max, level == TREND_RAW);
 
-    lv_style_init(&light_label_style);
-    lv_style_set_text_color(&light_label_style, lv_color_black());
+    view.chart_level = level;
+    view.chart_version = ring->version - 1;
 }
 
+static void view_refresh(void)
+{
+    char buf[UNITS_STR_LEN];
+    char rate_buf[UNITS_RATE_STR_LEN];
+    int value;
+    int velocity;
 
-void unit_swtich(void){
-
-    sw = lv_switch_create(lv_screen_active());
-    lv_obj_align(sw, LV_ALIGN_TOP_LEFT, 95, 10);
-    lv_obj_add_state(sw, LV_STATE_CHECKED);
-    lv_obj_add_event_cb(sw, sw_event_cb, LV_EVENT_VALUE_CHANGED, label);
-
-    cm_label = lv_label_create(lv_scr_act());
-    lv_label_set_text(cm_label, "cm");
-    lv_obj_align_to(cm_label, sw, LV_ALIGN_TOP_LEFT, 60, 10);
-    lv_obj_set_style_text_font(cm_label, &lv_font_montserrat_20, 0);
-
-    inch_label = lv_label_create(lv_scr_act());
-    lv_label_set_text(inch_label, "inches");
-    lv_obj_align_to(inch_label, sw, LV_ALIGN_TOP_LEFT, -75, 10);
-    lv_obj_set_style_text_font(inch_label, &lv_font_montserrat_20, 0);
-}
+    const struct trend_ring *ring;
 
-void pause_btn_event_cb(lv_event_t * e) {
-    if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        chart_paused = !chart_paused; 
+    if (!view.valid || chart_zoom != view.chart_level) {
+        chart_show_level(chart_zoom);
+    }
 
-        static lv_style_t red_style;
-        static bool styles_initialized = false;
+    ring = trend_get(view.chart_level);
+    if (ring->version != view.chart_version) {
+        // However many samples landed since the last frame, the chart is refreshed once
+        lv_chart_set_x_start_point(chart, series, ring->head);
+        lv_chart_set_x_start_point(chart, series_min, ring->head);
+        lv_chart_set_x_start_point(chart, series_max, ring->head);
+        lv_chart_refresh(chart);
+        view.chart_version = ring->version;
+    }
 
-        if (!styles_initialized) {
-            lv_style_init(&red_style);
-            lv_style_set_bg_color(&red_style, lv_palette_main(LV_PALETTE_RED));
-            lv_style_set_bg_opa(&red_style, LV_OPA_COVER);
+    value = units_convert(current_cm, display_unit);
 
-            styles_initialized = true;
-        }
+    velocity = current_cm_per_s < 0 ? -units_convert(-current_cm_per_s, display_unit)
+                                     : units_convert(current_cm_per_s, display_unit);
 
-        lv_obj_t *btn = lv_event_get_target_obj(e);
+    if (!view.valid || velocity != view.velocity_value || display_unit != view.label_unit) {
+        units_format_rate(current_cm_per_s, display_unit, rate_buf, sizeof(rate_buf));
+        lv_label_set_text(velocity_label, rate_buf);
+        view.velocity_value = velocity;
+    }
 
-        if (chart_paused) {
-            lv_obj_add_style(btn, &red_style, LV_PART_MAIN);
-        } else {
-            lv_obj_add_style(btn, &default_style, LV_PART_MAIN);
-            lv_obj_remove_style(btn, &red_style, LV_PART_MAIN);
-        }
+    if (!view.valid || value != view.label_value || display_unit != view.label_unit) {
+        units_format(current_cm, display_unit, buf, sizeof(buf));
+        lv_label_set_text(label, buf);
+        view.label_value = value;
+        view.label_unit = display_unit;
     }
-}
 
-void pause_button(void){
+    if (!view.valid || current_cm != view.bar_cm) {
+        lv_bar_set_value(bar, current_cm, LV_ANIM_ON);
+        view.bar_cm = current_cm;
+    }
 
-    lv_style_init(&default_style);
-    lv_style_set_bg_color(&default_style, lv_palette_main(LV_PALETTE_GREEN));
-    lv_style_set_bg_opa(&default_style, LV_OPA_COVER);
+    view.valid = true;
+}
 
-    pause_btn = lv_button_create(lv_screen_active());
-    lv_obj_align(pause_btn, LV_ALIGN_TOP_RIGHT, -20, 5);
-    lv_obj_set_size(pause_btn, 100, 50);
-    lv_obj_add_event_cb(pause_btn, pause_btn_event_cb, LV_EVENT_ALL, NULL);
-    lv_obj_add_style(pause_btn, &default_style, LV_PART_MAIN);
+static void sw_event_cb(lv_event_t * e){
+    lv_obj_t * sw = lv_event_get_target_obj(e);
 
-    lv_obj_t * pause = lv_label_create(pause_btn);         
-    lv_label_set_text(pause, "Pause");  
-    lv_obj_center(pause);
-    lv_obj_set_style_text_font(pause, &lv_font_montserrat_20, 0);
+    if (lv_obj_has_state(sw, LV_STATE_CHECKED)) {
+        display_unit = UNIT_CM;
+    } else {
+        display_unit = UNIT_INCH;
+    }
 }
 
-void set_theme(bool dark) {
-    if (dark) {
-        lv_obj_add_style(lv_scr_act(), &dark_bg_style, 0);
-        lv_obj_remove_style(lv_scr_act(), &light_bg_style, 0);
 
-        lv_obj_add_style(darkMode_btn, &dark_btn_style, LV_PART_MAIN);
+// Styles that never change, shared by every object using them
+static const lv_style_const_prop_t font_18_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&lv_font_montserrat_18),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_font_18, font_18_props);
+
+static const lv_style_const_prop_t font_20_props[] = {
+    LV_STYLE_CONST_TEXT_FONT(&lv_font_montserrat_20),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_font_20, font_20_props);
+
+static const lv_style_const_prop_t bar_indic_props[] = {
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_BG_COLOR(LV_COLOR_MAKE(255, 0, 0)),
+    LV_STYLE_CONST_BG_GRAD_COLOR(LV_COLOR_MAKE(0, 0, 255)),
+    LV_STYLE_CONST_BG_GRAD_DIR(LV_GRAD_DIR_HOR),
+    LV_STYLE_CONST_ANIM_DURATION(300),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_bar_indic, bar_indic_props);
+
+// Green and red of the LVGL palette
+static const lv_style_const_prop_t running_props[] = {
+    LV_STYLE_CONST_BG_COLOR(LV_COLOR_MAKE(0x4c, 0xaf, 0x50)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_running, running_props);
+
+static const lv_style_const_prop_t paused_props[] = {
+    LV_STYLE_CONST_BG_COLOR(LV_COLOR_MAKE(0xf4, 0x43, 0x36)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_paused, paused_props);
+
+static const lv_style_const_prop_t chart_props[] = {
+    LV_STYLE_CONST_BG_OPA(LV_OPA_TRANSP),
+    LV_STYLE_CONST_BORDER_WIDTH(0),
+    LV_STYLE_CONST_PAD_TOP(0),
+    LV_STYLE_CONST_PAD_BOTTOM(0),
+    LV_STYLE_CONST_PAD_LEFT(0),
+    LV_STYLE_CONST_PAD_RIGHT(0),
+    LV_STYLE_CONST_LINE_OPA(LV_OPA_TRANSP),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_chart, chart_props);
+
+// No point markers
+static const lv_style_const_prop_t chart_points_props[] = {
+    LV_STYLE_CONST_WIDTH(0),
+    LV_STYLE_CONST_HEIGHT(0),
+    LV_STYLE_CONST_PROPS_END,
+};
+static LV_STYLE_CONST_INIT(style_chart_points, chart_points_props);
 
-        lv_obj_add_style(label, &dark_label_style, 0);
-        lv_obj_add_style(title, &dark_label_style, 0);
-        lv_obj_add_style(cm_label, &dark_label_style, 0);
-        lv_obj_add_style(inch_label, &dark_label_style, 0);
 
-        lv_chart_set_series_color(chart, series, lv_palette_main(LV_PALETTE_ORANGE));
+void pause_btn_event_cb(lv_event_t * e) {
+    lv_obj_t *btn = lv_event_get_target_obj(e);
 
+    chart_paused = !chart_paused;
+    if (!chart_paused) {
+        k_sem_give(&resume_sem);
+    }
 
+    // The running style stays, the paused one is stacked on top while paused
+    if (chart_paused) {
+        lv_obj_add_style(btn, &style_paused, LV_PART_MAIN);
     } else {
-        lv_obj_add_style(lv_scr_act(), &light_bg_style, 0);
-        lv_obj_remove_style(lv_scr_act(), &dark_bg_style, 0);
-
-        lv_obj_add_style(darkMode_btn, &light_btn_style, LV_PART_MAIN);
-
-        lv_obj_add_style(label, &light_label_style, 0);
-        lv_obj_add_style(title, &light_label_style, 0);
-        lv_obj_add_style(cm_label, &light_label_style, 0);
-        lv_obj_add_style(inch_label, &light_label_style, 0);
-
-
-        lv_chart_set_series_color(chart, series, lv_palette_main(LV_PALETTE_BLUE));
-
+        lv_obj_remove_style(btn, &style_paused, LV_PART_MAIN);
     }
 }
 
-
-static void dark_btn_event_cb(lv_event_t *e) {
-    if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        is_dark_mode = !is_dark_mode;
-        set_theme(is_dark_mode);
-    }
+void set_theme(bool dark) {
+    // Restyles both screens through the shared role styles
+    theme_apply(dark ? THEME_DARK : THEME_LIGHT);
+    lv_chart_set_series_color(chart, series, theme_series_color());
 }
 
-void dark_mode(void){
-    darkMode_btn = lv_button_create(lv_scr_act());
-    lv_obj_align(darkMode_btn, LV_ALIGN_TOP_RIGHT, -140, 5);
-    lv_obj_set_size(darkMode_btn, 130, 50);
-    lv_obj_add_event_cb(darkMode_btn, dark_btn_event_cb, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_t *label = lv_label_create(darkMode_btn);
-    lv_label_set_text(label, "Dark Mode");
-    lv_obj_center(label);
-    lv_obj_set_style_text_font(label, &lv_font_montserrat_20, 0);
+static void dark_btn_event_cb(lv_event_t *e) {
+    is_dark_mode = !is_dark_mode;
+    set_theme(is_dark_mode);
 }
 
-void distance_bar(void)
+static void bar_setup(lv_obj_t *obj)
 {
-    lv_style_init(&style_bar_indic);
-    lv_style_set_bg_opa(&style_bar_indic, LV_OPA_COVER);
-    lv_style_set_bg_color(&style_bar_indic, lv_color_make(255, 0, 0));
-    lv_style_set_bg_grad_color(&style_bar_indic, lv_color_make(0, 0, 255));
-    lv_style_set_bg_grad_dir(&style_bar_indic, LV_GRAD_DIR_HOR);
-
-    title = lv_label_create(lv_scr_act());
-    lv_label_set_text(title, "Distance Monitor");
-    lv_obj_align(title, LV_ALIGN_BOTTOM_MID, 0, -5);
-    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
-
-    bar = lv_bar_create(lv_scr_act());
-    lv_bar_set_range(bar, MIN_VALUE, MAX_VALUE);
-    lv_obj_set_size(bar, 400, 30);
-    lv_obj_align_to(bar, chart, LV_ALIGN_CENTER, 0, 60);
-
-    lv_obj_add_style(bar, &style_bar_indic, LV_PART_INDICATOR);
-    lv_obj_set_style_anim_time(bar, 300, LV_PART_INDICATOR);
-
-    label = lv_label_create(lv_scr_act());
-    lv_label_set_text(label, "0");
-    lv_obj_align_to(label, bar, LV_ALIGN_OUT_BOTTOM_MID, -20, 5);
-    lv_obj_set_style_text_font(label, &lv_font_montserrat_18, 0); 
+    lv_bar_set_range(obj, MIN_VALUE, MAX_VALUE);
 }
 
+static void chart_setup(lv_obj_t *obj)
+{
+    lv_chart_set_type(obj, LV_CHART_TYPE_LINE);
+    lv_chart_set_range(obj, LV_CHART_AXIS_PRIMARY_Y, MIN_VALUE, MAX_VALUE);
+    lv_chart_set_point_count(obj, CONFIG_APP_TREND_POINTS);
+    lv_chart_set_update_mode(obj, LV_CHART_UPDATE_MODE_SHIFT);
+
+    series_min = lv_chart_add_series(obj, lv_palette_lighten(LV_PALETTE_GREY, 2),
+                                     LV_CHART_AXIS_PRIMARY_Y);
+    series_max = lv_chart_add_series(obj, lv_palette_lighten(LV_PALETTE_GREY, 2),
+                                     LV_CHART_AXIS_PRIMARY_Y);
+    // Added last so the mean is drawn on top of the min/max envelope
+    series = lv_chart_add_series(obj, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+}
 
-void distance_chart(void){
-    chart = lv_chart_create(lv_scr_act());
-    lv_obj_set_size(chart, 400, 120);
-    lv_obj_align_to(chart, bar, LV_ALIGN_OUT_TOP_MID, 0, -10);
-    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, MIN_VALUE, MAX_VALUE);
-    lv_chart_set_point_count(chart, 50);
-    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
-
-    series = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
-
-    lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(chart, 0, LV_PART_MAIN);
-    lv_obj_set_style_pad_all(chart, 0, LV_PART_MAIN);
-    lv_obj_set_style_line_opa(chart, LV_OPA_TRANSP, LV_PART_MAIN);
+static void zoom_btn_event_cb(lv_event_t * e) {
+    chart_zoom = (chart_zoom + 1) % TREND_LEVEL_COUNT;
+    lv_label_set_text_static(zoom_label, trend_level_name(chart_zoom));
+}
 
-    lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR);
+static void zoom_label_setup(lv_obj_t *obj)
+{
+    lv_label_set_text_static(obj, trend_level_name(chart_zoom));
 }
 
 void save_current_point(void) {
-    if (saved_count >= MAX_POINTS) {
-        return; // Array is full
+    // Save the distance currently on screen, written to flash in the background
+    int ret = point_store_append(current_cm, k_uptime_get_32());
+
+    if (ret != 0) {
+        LOG_ERR("Failed to save point: %d", ret);
     }
-    
-    // Convert sensor value to cm (same logic as in update_distance)
-    int total_cm = sensor_val.val1 * 100 + sensor_val.val2 / 10000;
-    
-    // Clamp value if needed
-    if (total_cm < MIN_VALUE) total_cm = MIN_VALUE;
-    if (total_cm > MAX_VALUE) total_cm = MAX_VALUE;
-    
-    // Save the current distance
-    saved_points[saved_count] = total_cm;
-    saved_count++;
 }
 
 
-void back_to_main_cb(lv_event_t * e) {
-    lv_scr_load(main_screen);   // Switch back to main screen
-
-    if (history_screen != NULL) {
-        lv_obj_del(history_screen);  // Delete history UI elements
-        history_screen = NULL;
-    }
-}
+// History rows are a fixed pool of labels moved along a list as tall as all points together.
+// Only the rows in view exist, so the screen costs the same for 50 or 50,000 points.
+#define HISTORY_ROW_H     20
+#define HISTORY_LIST_TOP  LAYOUT_Y(40)
+#define HISTORY_LIST_W    (LAYOUT_W - LAYOUT_X(140))
+#define HISTORY_LIST_H    (LAYOUT_H - HISTORY_LIST_TOP - LAYOUT_Y(10))
+// Enough rows to cover the list while one row is scrolled partly out at each end
+#define HISTORY_ROWS      (HISTORY_LIST_H / HISTORY_ROW_H + 2)
 
+static lv_obj_t *history_list;
+static lv_obj_t *history_spacer;
+static lv_obj_t *history_rows[HISTORY_ROWS];
+// Point shown by each row, -1 if the row is empty or stale
+static int history_row_index[HISTORY_ROWS];
+static enum distance_unit history_unit;
 
-void reset_cb(lv_event_t * e) {
-    // Clear saved points
-    for (int i = 0; i < saved_count; i++) {
-        saved_points[i] = 0;
+static void history_invalidate_rows(void)
+{
+    for (int i = 0; i < HISTORY_ROWS; i++) {
+        history_row_index[i] = -1;
     }
-    saved_count = 0;
-
-    history_points();
 }
 
-void history_points(void) {
-    history_screen = lv_obj_create(NULL);  // Create a new screen
-
-    // Set background color based on theme
-    if (is_dark_mode) {
-        lv_obj_set_style_bg_color(history_screen, lv_color_hex(0x121212), 0);
-        // lv_obj_add_style(hist_title, &dark_label_style, 0);
-        // lv_obj_add_style(point_label, &dark_label_style, 0);
+// Point the pool at the rows in view, only rows that now show another point are redrawn
+static void history_refresh_rows(void)
+{
+    size_t count = point_store_count();
+    int first = lv_obj_get_scroll_y(history_list) / HISTORY_ROW_H;
 
-    } else {
-        lv_obj_set_style_bg_color(history_screen, lv_color_hex(0xf0f0f0), 0);
-        // lv_obj_add_style(hist_title, &light_label_style, 0);
-        // lv_obj_add_style(point_label, &light_label_style, 0);
+    if (display_unit != history_unit) {
+        history_invalidate_rows();
+        history_unit = display_unit;
     }
 
-    // Add a title label
-    hist_title = lv_label_create(history_screen);
-    lv_label_set_text(hist_title, "Saved Points History");
-    lv_obj_align(hist_title, LV_ALIGN_TOP_MID, 0, 10);
-    lv_obj_set_style_text_font(hist_title, &lv_font_montserrat_20, 0); 
-
-    if (is_dark_mode) {
-        lv_obj_add_style(hist_title, &dark_label_style, 0);
-
-    } else {
-        lv_obj_add_style(hist_title, &light_label_style, 0);
+    if (first < 0) {
+        first = 0;
     }
 
-    // Show all saved points
-    for (int i = 0; i < saved_count; i++) {
+    for (int i = 0; i < HISTORY_ROWS; i++) {
+        // Row i shows the point in view whose index is i modulo the pool size, so scrolling
+        // by one row moves a single label
+        int offset = (i - first % HISTORY_ROWS + HISTORY_ROWS) % HISTORY_ROWS;
+        int index = first + offset;
+        lv_obj_t *row = history_rows[i];
+        struct saved_point point;
         char buf[32];
+        char value[UNITS_STR_LEN];
 
-        if (use_cm) {
-            lv_snprintf(buf, sizeof(buf), "Point %d: %d cm", i + 1, saved_points[i]);
-        } else {
-            int inches = saved_points[i] / 2.54;
-            lv_snprintf(buf, sizeof(buf), "Point %d: %d ''", i + 1, inches);
+        if (history_row_index[i] == index) {
+            continue;
         }
 
-        point_label = lv_label_create(history_screen);
-        lv_label_set_text(point_label, buf);
-        lv_obj_align(point_label, LV_ALIGN_TOP_LEFT, 10, 40 + i * 20);
+        if ((size_t)index >= count || point_store_get(index, &point) != 0) {
+            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            history_row_index[i] = -1;
+            continue;
+        }
 
-        if (is_dark_mode) {
-            lv_obj_add_style(point_label, &dark_label_style, 0);
+        // Same conversion and rounding as the live label
+        units_format(point.cm, display_unit, value, sizeof(value));
+        lv_snprintf(buf, sizeof(buf), "Point %d: %s", index + 1, value);
+        lv_label_set_text(row, buf);
+        lv_obj_set_y(row, index * HISTORY_ROW_H);
+        lv_obj_remove_flag(row, LV_OBJ_FLAG_HIDDEN);
+        history_row_index[i] = index;
+    }
+}
 
-        } else {
-            lv_obj_add_style(point_label, &light_label_style, 0);
-        }
+static void history_scroll_cb(lv_event_t * e) {
+    history_refresh_rows();
+}
+
+static void history_list_setup(lv_obj_t *obj)
+{
+    lv_obj_set_scroll_dir(obj, LV_DIR_VER);
+
+    for (int i = 0; i < HISTORY_ROWS; i++) {
+        history_rows[i] = lv_label_create(obj);
+        lv_obj_add_flag(history_rows[i], LV_OBJ_FLAG_HIDDEN);
     }
+    history_invalidate_rows();
+}
+
+void back_to_main_cb(lv_event_t * e) {
+    lv_scr_load(main_screen);   // Switch back to main screen, the history screen is kept
+}
 
-    // Create a "Back" button
-    lv_obj_t *back_btn = lv_button_create(history_screen);
-    lv_obj_set_size(back_btn, 100, 40);
-    lv_obj_align(back_btn, LV_ALIGN_TOP_RIGHT, -10, 30);
-    lv_obj_add_event_cb(back_btn, back_to_main_cb, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_t *back_label = lv_label_create(back_btn);
-    lv_label_set_text(back_label, "Back");
-    lv_obj_center(back_label);
+void reset_cb(lv_event_t * e) {
+    // Clear saved points
+    point_store_clear();
+
+    history_points();
+}
 
-    //create reset button
-    lv_obj_t *reset_btn = lv_button_create(history_screen);
-    lv_obj_set_size(reset_btn, 100, 40);
-    lv_obj_align(reset_btn, LV_ALIGN_RIGHT_MID, -10, -10);
-    lv_obj_add_event_cb(reset_btn, reset_cb, LV_EVENT_CLICKED, NULL);
+void history_points(void) {
+    int32_t content_h;
 
-    lv_obj_t *reset_label = lv_label_create(reset_btn);
-    lv_label_set_text(reset_label, "Reset");
-    lv_obj_center(reset_label);
+    // Points may have been saved or cleared since the last visit, start at the newest ones
+    content_h = point_store_count() * HISTORY_ROW_H;
+    lv_obj_set_size(history_spacer, 1, content_h);
+    lv_obj_update_layout(history_list);
+    lv_obj_scroll_to_y(history_list, MAX(content_h - lv_obj_get_height(history_list), 0),
+                       LV_ANIM_OFF);
+    history_invalidate_rows();
+    history_refresh_rows();
 
     // Load the history screen
     lv_scr_load(history_screen);
@@ -426,64 +480,240 @@ void history_points(void) {
 
 
 void save_btn_event_cb(lv_event_t * e) {
-    if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        save_current_point();
-    }
+    save_current_point();
 }
 
 void history_btn_event_cb(lv_event_t * e) {
-    if (lv_event_get_code(e) == LV_EVENT_CLICKED) {
-        history_points();
-    }
+    history_points();
 }
 
-void create_save_history_buttons(void) {
-    save_btn = lv_button_create(lv_scr_act());
-    lv_obj_set_size(save_btn, 80, 40);
-    lv_obj_align(save_btn, LV_ALIGN_BOTTOM_LEFT, 10, -10);
-    lv_obj_add_event_cb(save_btn, save_btn_event_cb, LV_EVENT_CLICKED, NULL);
-    lv_obj_t * save_label = lv_label_create(save_btn);
-    lv_label_set_text(save_label, "Save");
-    lv_obj_center(save_label);
-
-    history_btn = lv_button_create(lv_scr_act());
-    lv_obj_set_size(history_btn, 80, 40);
-    lv_obj_align(history_btn, LV_ALIGN_BOTTOM_RIGHT, -10, -10);
-    lv_obj_add_event_cb(history_btn, history_btn_event_cb, LV_EVENT_CLICKED, NULL);
-    lv_obj_t * load_label = lv_label_create(history_btn);
-    lv_label_set_text(load_label, "History");
-    lv_obj_center(load_label);
-}
+
+// Main screen, created in this order. Nodes only refer to nodes above them.
+enum main_node {
+    MAIN_TITLE,
+    MAIN_BAR,
+    MAIN_LABEL,
+    MAIN_VELOCITY,
+    MAIN_CHART,
+    MAIN_SWITCH,
+    MAIN_CM,
+    MAIN_INCH,
+    MAIN_ZOOM_BTN,
+    MAIN_ZOOM_LABEL,
+    MAIN_PAUSE_BTN,
+    MAIN_PAUSE_LABEL,
+    MAIN_DARK_BTN,
+    MAIN_DARK_LABEL,
+    MAIN_SAVE_BTN,
+    MAIN_SAVE_LABEL,
+    MAIN_HISTORY_BTN,
+    MAIN_HISTORY_LABEL,
+    MAIN_NODE_COUNT,
+};
+
+static const struct layout_node main_layout[MAIN_NODE_COUNT] = {
+    [MAIN_TITLE] = {
+        .type = LAYOUT_LABEL, .obj = &title, .text = "Distance Monitor",
+        .align = LV_ALIGN_BOTTOM_MID, .y = LAYOUT_Y(-5),
+        .styles = { { &style_font_20, 0 }, { &theme_text_style, 0 } },
+    },
+    [MAIN_BAR] = {
+        .type = LAYOUT_BAR, .obj = &bar, .setup = bar_setup,
+        .align = LV_ALIGN_CENTER, .y = LAYOUT_Y(60), .w = LAYOUT_X(400), .h = LAYOUT_Y(30),
+        .styles = { { &style_bar_indic, LV_PART_INDICATOR } },
+    },
+    [MAIN_LABEL] = {
+        .type = LAYOUT_LABEL, .obj = &label, .text = "0",
+        .align_to = LAYOUT_REF(MAIN_BAR), .align = LV_ALIGN_OUT_BOTTOM_MID,
+        .x = LAYOUT_X(-20), .y = LAYOUT_Y(5),
+        .styles = { { &style_font_18, 0 }, { &theme_text_style, 0 } },
+    },
+    // Closing speed, right of the distance so both read as one line
+    [MAIN_VELOCITY] = {
+        .type = LAYOUT_LABEL, .obj = &velocity_label, .text = "",
+        .align_to = LAYOUT_REF(MAIN_BAR), .align = LV_ALIGN_OUT_BOTTOM_RIGHT,
+        .y = LAYOUT_Y(5),
+        .styles = { { &style_font_18, 0 }, { &theme_text_style, 0 } },
+    },
+    [MAIN_CHART] = {
+        .type = LAYOUT_CHART, .obj = &chart, .setup = chart_setup,
+        .align_to = LAYOUT_REF(MAIN_BAR), .align = LV_ALIGN_OUT_TOP_MID,
+        .y = LAYOUT_Y(-10), .w = LAYOUT_X(400), .h = LAYOUT_Y(120),
+        .styles = { { &style_chart, LV_PART_MAIN }, { &style_chart_points, LV_PART_INDICATOR } },
+    },
+    [MAIN_SWITCH] = {
+        .type = LAYOUT_SWITCH, .obj = &sw, .state = LV_STATE_CHECKED,
+        .align = LV_ALIGN_TOP_LEFT, .x = LAYOUT_X(95), .y = LAYOUT_Y(10),
+        .event_cb = sw_event_cb, .event = LV_EVENT_VALUE_CHANGED,
+    },
+    [MAIN_CM] = {
+        .type = LAYOUT_LABEL, .obj = &cm_label, .text = "cm",
+        .align_to = LAYOUT_REF(MAIN_SWITCH), .align = LV_ALIGN_TOP_LEFT,
+        .x = LAYOUT_X(60), .y = LAYOUT_Y(10),
+        .styles = { { &style_font_20, 0 }, { &theme_text_style, 0 } },
+    },
+    [MAIN_INCH] = {
+        .type = LAYOUT_LABEL, .obj = &inch_label, .text = "inches",
+        .align_to = LAYOUT_REF(MAIN_SWITCH), .align = LV_ALIGN_TOP_LEFT,
+        .x = LAYOUT_X(-75), .y = LAYOUT_Y(10),
+        .styles = { { &style_font_20, 0 }, { &theme_text_style, 0 } },
+    },
+    [MAIN_ZOOM_BTN] = {
+        .type = LAYOUT_BUTTON, .obj = &zoom_btn,
+        .align = LV_ALIGN_BOTTOM_LEFT, .x = LAYOUT_X(100), .y = LAYOUT_Y(-10),
+        .w = LAYOUT_X(80), .h = LAYOUT_Y(40),
+        .event_cb = zoom_btn_event_cb, .event = LV_EVENT_CLICKED,
+    },
+    [MAIN_ZOOM_LABEL] = {
+        .type = LAYOUT_LABEL, .obj = &zoom_label, .parent = LAYOUT_REF(MAIN_ZOOM_BTN),
+        .align = LV_ALIGN_CENTER, .setup = zoom_label_setup,
+    },
+    [MAIN_PAUSE_BTN] = {
+        .type = LAYOUT_BUTTON, .obj = &pause_btn,
+        .align = LV_ALIGN_TOP_RIGHT, .x = LAYOUT_X(-20), .y = LAYOUT_Y(5),
+        .w = LAYOUT_X(100), .h = LAYOUT_Y(50),
+        .styles = { { &style_running, LV_PART_MAIN } },
+        .event_cb = pause_btn_event_cb, .event = LV_EVENT_CLICKED,
+    },
+    [MAIN_PAUSE_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(MAIN_PAUSE_BTN), .text = "Pause",
+        .align = LV_ALIGN_CENTER,
+        .styles = { { &style_font_20, 0 } },
+    },
+    [MAIN_DARK_BTN] = {
+        .type = LAYOUT_BUTTON, .obj = &darkMode_btn,
+        .align = LV_ALIGN_TOP_RIGHT, .x = LAYOUT_X(-140), .y = LAYOUT_Y(5),
+        .w = LAYOUT_X(130), .h = LAYOUT_Y(50),
+        .styles = { { &theme_button_style, LV_PART_MAIN } },
+        .event_cb = dark_btn_event_cb, .event = LV_EVENT_CLICKED,
+    },
+    [MAIN_DARK_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(MAIN_DARK_BTN), .text = "Dark Mode",
+        .align = LV_ALIGN_CENTER,
+        .styles = { { &style_font_20, 0 } },
+    },
+    [MAIN_SAVE_BTN] = {
+        .type = LAYOUT_BUTTON, .obj = &save_btn,
+        .align = LV_ALIGN_BOTTOM_LEFT, .x = LAYOUT_X(10), .y = LAYOUT_Y(-10),
+        .w = LAYOUT_X(80), .h = LAYOUT_Y(40),
+        .event_cb = save_btn_event_cb, .event = LV_EVENT_CLICKED,
+    },
+    [MAIN_SAVE_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(MAIN_SAVE_BTN), .text = "Save",
+        .align = LV_ALIGN_CENTER,
+    },
+    [MAIN_HISTORY_BTN] = {
+        .type = LAYOUT_BUTTON, .obj = &history_btn,
+        .align = LV_ALIGN_BOTTOM_RIGHT, .x = LAYOUT_X(-10), .y = LAYOUT_Y(-10),
+        .w = LAYOUT_X(80), .h = LAYOUT_Y(40),
+        .event_cb = history_btn_event_cb, .event = LV_EVENT_CLICKED,
+    },
+    [MAIN_HISTORY_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(MAIN_HISTORY_BTN), .text = "History",
+        .align = LV_ALIGN_CENTER,
+    },
+};
+
+enum history_node {
+    HISTORY_TITLE,
+    HISTORY_LIST,
+    HISTORY_SPACER,
+    HISTORY_BACK_BTN,
+    HISTORY_BACK_LABEL,
+    HISTORY_RESET_BTN,
+    HISTORY_RESET_LABEL,
+    HISTORY_NODE_COUNT,
+};
+
+static const struct layout_node history_layout[HISTORY_NODE_COUNT] = {
+    [HISTORY_TITLE] = {
+        .type = LAYOUT_LABEL, .obj = &hist_title, .text = "Saved Points History",
+        .align = LV_ALIGN_TOP_MID, .y = LAYOUT_Y(10),
+        .styles = { { &style_font_20, 0 }, { &theme_text_style, 0 } },
+    },
+    [HISTORY_LIST] = {
+        .type = LAYOUT_OBJ, .obj = &history_list, .bare = true, .setup = history_list_setup,
+        .align = LV_ALIGN_TOP_LEFT, .x = LAYOUT_X(10), .y = HISTORY_LIST_TOP,
+        .w = HISTORY_LIST_W, .h = HISTORY_LIST_H,
+        // Rows inherit the text color from the list
+        .styles = { { &theme_text_style, 0 } },
+        .event_cb = history_scroll_cb, .event = LV_EVENT_SCROLL,
+    },
+    // Gives the list the height of all points so it scrolls over all of them
+    [HISTORY_SPACER] = {
+        .type = LAYOUT_OBJ, .obj = &history_spacer, .parent = LAYOUT_REF(HISTORY_LIST),
+        .bare = true, .clear_flags = LV_OBJ_FLAG_CLICKABLE, .w = 1,
+    },
+    [HISTORY_BACK_BTN] = {
+        .type = LAYOUT_BUTTON,
+        .align = LV_ALIGN_TOP_RIGHT, .x = LAYOUT_X(-10), .y = LAYOUT_Y(30),
+        .w = LAYOUT_X(100), .h = LAYOUT_Y(40),
+        .event_cb = back_to_main_cb, .event = LV_EVENT_CLICKED,
+    },
+    [HISTORY_BACK_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(HISTORY_BACK_BTN), .text = "Back",
+        .align = LV_ALIGN_CENTER,
+    },
+    [HISTORY_RESET_BTN] = {
+        .type = LAYOUT_BUTTON,
+        .align = LV_ALIGN_RIGHT_MID, .x = LAYOUT_X(-10), .y = LAYOUT_Y(-10),
+        .w = LAYOUT_X(100), .h = LAYOUT_Y(40),
+        .event_cb = reset_cb, .event = LV_EVENT_CLICKED,
+    },
+    [HISTORY_RESET_LABEL] = {
+        .type = LAYOUT_LABEL, .parent = LAYOUT_REF(HISTORY_RESET_BTN), .text = "Reset",
+        .align = LV_ALIGN_CENTER,
+    },
+};
 
 
 int main(void)
 {
     const struct device *sensor_dev = DEVICE_DT_GET_ONE(maxbotix_mb7040);
+    lv_obj_t *main_objs[MAIN_NODE_COUNT];
+    lv_obj_t *history_objs[HISTORY_NODE_COUNT];
     k_msleep(500);
 
     if (!device_is_ready(sensor_dev)) {
         printk("Device not ready\n");
         return -1;
     }
+    if (point_store_init() != 0) {
+        printk("Saved points storage not available\n");
+    }
+
+    trend_init();
+
     main_screen = lv_scr_act();
-    init_styles();
+    theme_init();
 
-    use_cm = true;
+    display_unit = UNIT_CM;
     chart_paused = false;
     is_dark_mode = false;
-    distance_bar();
-    unit_swtich();
-    distance_chart();
-    pause_button();
-    dark_mode();
+
+    // Both screens are built up front, switching screens only loads them
+    layout_build(main_screen, main_layout, ARRAY_SIZE(main_layout), main_objs);
+    history_screen = lv_obj_create(NULL);
+    layout_build(history_screen, history_layout, ARRAY_SIZE(history_layout), history_objs);
+    lv_obj_add_style(main_screen, &theme_bg_style, 0);
+    lv_obj_add_style(history_screen, &theme_bg_style, 0);
     set_theme(false);
-    create_save_history_buttons();
+
+    // Sensor latency stays on this thread, the UI loop below only touches LVGL
+    k_thread_create(&sensor_thread_data, sensor_stack, K_THREAD_STACK_SIZEOF(sensor_stack),
+                    sensor_thread, (void *)sensor_dev, NULL, NULL,
+                    CONFIG_APP_SENSOR_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&sensor_thread_data, "sensor");
+
     while (1) {
-        if (!chart_paused) {
-            update_distance(sensor_dev);
+        struct distance_sample sample;
+
+        while (k_msgq_get(&sample_msgq, &sample, K_NO_WAIT) == 0) {
+            update_distance(sample.cm, sample.cm_per_s, sample.timestamp_ms);
         }
+        view_refresh();
         lv_timer_handler();
-        k_sleep(K_MSEC(50)); 
+        k_sleep(K_MSEC(CONFIG_APP_UI_PERIOD_MS));
     }
 
     return 0;
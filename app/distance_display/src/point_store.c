@@ -0,0 +1,441 @@
+#include "point_store.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+LOG_MODULE_REGISTER(point_store, LOG_LEVEL_INF);
+
+/*
+ * Points are kept in chunks of CHUNK_POINTS, one NVS entry each, in an append-only ring of up to
+ * CONFIG_APP_POINT_STORE_MAX_CHUNKS entries. NVS itself never rewrites in place, so rewriting the
+ * chunk being filled just appends a new copy and flash wear is spread over the partition.
+ *
+ * A chunk holds its first point in full, then one record per further point:
+ *   varint(zigzag(cm - previous cm))
+ *   varint(ms since previous point << 1), or 1 if the time is absolute, followed by
+ *   varint(boots since previous point) and varint(uptime in ms)
+ * Points saved seconds apart at similar distances take 3-4 bytes instead of 8.
+ *
+ * The meta entry only records which chunks exist, so startup reads it and the newest chunk
+ * and nothing else. Older chunks are read when points in them are requested.
+ */
+
+#define STORE_PARTITION storage_partition
+
+#define META_ID      0
+#define CHUNK_POINTS CONFIG_APP_POINT_STORE_CHUNK_POINTS
+#define MAX_CHUNKS   CONFIG_APP_POINT_STORE_MAX_CHUNKS
+// Chunk with sequence number seq lives at NVS id 1 + seq % MAX_CHUNKS
+#define CHUNK_ID(seq) ((uint16_t)(1 + (seq) % MAX_CHUNKS))
+
+// Longest encoding of one record: cm, absolute time tag, boots and uptime
+#define RECORD_MAX_LEN (3 + 1 + 3 + 5)
+// Record time tag for a point not relative to the previous one
+#define TIME_ABSOLUTE 1
+
+struct store_meta {
+    // Oldest chunk still stored
+    uint32_t first_seq;
+    // Chunk being filled, holds cur_count points
+    uint32_t cur_seq;
+    uint16_t boot;
+} __packed;
+
+struct chunk_header {
+    // Guards against reading a stale entry of an id that wrapped around
+    uint32_t seq;
+    uint8_t count;
+    uint16_t boot;
+    uint16_t cm;
+    uint32_t time_ms;
+} __packed;
+
+static struct nvs_fs fs;
+static struct store_meta meta;
+static K_MUTEX_DEFINE(store_lock);
+
+// Chunk being filled
+static struct saved_point cur[CHUNK_POINTS];
+static size_t cur_count;
+static bool cur_dirty;
+
+// Last older chunk read back, so sequential reads decode each chunk once
+static struct saved_point cache[CHUNK_POINTS];
+static uint32_t cache_seq;
+static bool cache_valid;
+
+static uint8_t chunk_buf[sizeof(struct chunk_header) + (CHUNK_POINTS - 1) * RECORD_MAX_LEN];
+
+static void flush_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static size_t put_varint(uint8_t *buf, uint32_t value)
+{
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        buf[len++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    buf[len++] = value;
+
+    return len;
+}
+
+// Returns the bytes consumed, 0 if the varint runs past end
+static size_t get_varint(const uint8_t *buf, const uint8_t *end, uint32_t *value)
+{
+    size_t len = 0;
+
+    *value = 0;
+    while (&buf[len] < end && len < 5) {
+        *value |= (uint32_t)(buf[len] & 0x7f) << (7 * len);
+        if ((buf[len++] & 0x80) == 0) {
+            return len;
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static size_t encode_chunk(uint32_t seq, const struct saved_point *points, size_t count)
+{
+    struct chunk_header hdr = {
+        .seq = seq,
+        .count = count,
+        .boot = points[0].boot,
+        .cm = points[0].cm,
+        .time_ms = points[0].time_ms,
+    };
+    size_t len = sizeof(hdr);
+
+    memcpy(chunk_buf, &hdr, sizeof(hdr));
+
+    for (size_t i = 1; i < count; i++) {
+        const struct saved_point *prev = &points[i - 1];
+        const struct saved_point *pt = &points[i];
+        uint32_t dt = pt->time_ms - prev->time_ms;
+
+        len += put_varint(&chunk_buf[len], zigzag((int32_t)pt->cm - prev->cm));
+        if (pt->boot == prev->boot && dt < BIT(31)) {
+            len += put_varint(&chunk_buf[len], dt << 1);
+        } else {
+            len += put_varint(&chunk_buf[len], TIME_ABSOLUTE);
+            len += put_varint(&chunk_buf[len], (uint16_t)(pt->boot - prev->boot));
+            len += put_varint(&chunk_buf[len], pt->time_ms);
+        }
+    }
+
+    return len;
+}
+
+// Returns the number of points decoded, 0 if the entry is missing or not chunk seq
+static size_t read_chunk(uint32_t seq, struct saved_point *points)
+{
+    struct chunk_header hdr;
+    const uint8_t *pos;
+    const uint8_t *end;
+    ssize_t len;
+
+    len = nvs_read(&fs, CHUNK_ID(seq), chunk_buf, sizeof(chunk_buf));
+    if (len < (ssize_t)sizeof(hdr)) {
+        return 0;
+    }
+
+    memcpy(&hdr, chunk_buf, sizeof(hdr));
+    if (hdr.seq != seq || hdr.count == 0 || hdr.count > CHUNK_POINTS) {
+        return 0;
+    }
+
+    points[0].boot = hdr.boot;
+    points[0].cm = hdr.cm;
+    points[0].time_ms = hdr.time_ms;
+
+    pos = &chunk_buf[sizeof(hdr)];
+    end = &chunk_buf[MIN((size_t)len, sizeof(chunk_buf))];
+
+    for (size_t i = 1; i < hdr.count; i++) {
+        uint32_t fields[4];
+        size_t nfields = 2;
+
+        // A truncated entry still yields the points before the damage
+        for (size_t f = 0; f < nfields; f++) {
+            size_t n = get_varint(pos, end, &fields[f]);
+
+            if (n == 0) {
+                return i;
+            }
+            pos += n;
+            if (f == 1 && fields[1] == TIME_ABSOLUTE) {
+                nfields = 4;
+            }
+        }
+
+        points[i].cm = points[i - 1].cm + unzigzag(fields[0]);
+        if (fields[1] == TIME_ABSOLUTE) {
+            points[i].boot = points[i - 1].boot + fields[2];
+            points[i].time_ms = fields[3];
+        } else {
+            points[i].boot = points[i - 1].boot;
+            points[i].time_ms = points[i - 1].time_ms + (fields[1] >> 1);
+        }
+    }
+
+    return hdr.count;
+}
+
+static int write_meta(void)
+{
+    ssize_t ret = nvs_write(&fs, META_ID, &meta, sizeof(meta));
+
+    return ret < 0 ? (int)ret : 0;
+}
+
+static int drop_oldest_chunk(void)
+{
+    if (meta.first_seq == meta.cur_seq) {
+        return -ENOSPC;
+    }
+
+    nvs_delete(&fs, CHUNK_ID(meta.first_seq));
+    if (cache_valid && cache_seq == meta.first_seq) {
+        cache_valid = false;
+    }
+    meta.first_seq++;
+
+    return write_meta();
+}
+
+// Called with store_lock held
+static int write_cur_chunk(void)
+{
+    size_t len;
+    ssize_t ret;
+
+    if (!cur_dirty || cur_count == 0) {
+        return 0;
+    }
+
+    len = encode_chunk(meta.cur_seq, cur, cur_count);
+
+    // Partition full, the oldest points make room for the new ones
+    while ((ret = nvs_write(&fs, CHUNK_ID(meta.cur_seq), chunk_buf, len)) == -ENOSPC) {
+        int err = drop_oldest_chunk();
+
+        if (err != 0) {
+            return err;
+        }
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to write chunk %u: %d", (unsigned int)meta.cur_seq, (int)ret);
+        return ret;
+    }
+
+    cur_dirty = false;
+    return 0;
+}
+
+// Called with store_lock held once the chunk being filled is full and written
+static int open_next_chunk(void)
+{
+    int ret;
+
+    if (meta.cur_seq + 1 - meta.first_seq >= MAX_CHUNKS) {
+        // The next chunk's id is still taken by the oldest one
+        ret = drop_oldest_chunk();
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    meta.cur_seq++;
+    cur_count = 0;
+    return write_meta();
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    point_store_flush();
+}
+
+int point_store_flush(void)
+{
+    int ret;
+
+    k_mutex_lock(&store_lock, K_FOREVER);
+    ret = write_cur_chunk();
+    k_mutex_unlock(&store_lock);
+
+    return ret;
+}
+
+int point_store_init(void)
+{
+    struct flash_pages_info info;
+    ssize_t len;
+    int ret;
+
+    fs.flash_device = FIXED_PARTITION_DEVICE(STORE_PARTITION);
+    if (!device_is_ready(fs.flash_device)) {
+        LOG_ERR("Flash device not ready");
+        return -ENODEV;
+    }
+
+    fs.offset = FIXED_PARTITION_OFFSET(STORE_PARTITION);
+    ret = flash_get_page_info_by_offs(fs.flash_device, fs.offset, &info);
+    if (ret != 0) {
+        return ret;
+    }
+    fs.sector_size = info.size;
+    fs.sector_count = FIXED_PARTITION_SIZE(STORE_PARTITION) / info.size;
+
+    ret = nvs_mount(&fs);
+    if (ret != 0) {
+        LOG_ERR("Failed to mount NVS: %d", ret);
+        return ret;
+    }
+
+    len = nvs_read(&fs, META_ID, &meta, sizeof(meta));
+    if (len != sizeof(meta)) {
+        memset(&meta, 0, sizeof(meta));
+    }
+
+    if (meta.cur_seq - meta.first_seq >= MAX_CHUNKS) {
+        // Left by a reset that opened a chunk without dropping the oldest, which shares its id
+        meta.first_seq = meta.cur_seq + 1 - MAX_CHUNKS;
+    }
+
+    meta.boot++;
+    cur_count = read_chunk(meta.cur_seq, cur);
+    if (cur_count == CHUNK_POINTS) {
+        // Filled up right before a reset, start the next one
+        ret = open_next_chunk();
+    } else {
+        ret = write_meta();
+    }
+
+    LOG_INF("%u points stored, boot %u", (unsigned int)point_store_count(),
+            (unsigned int)meta.boot);
+
+    return ret;
+}
+
+int point_store_append(uint16_t cm, uint32_t time_ms)
+{
+    int ret = 0;
+
+    k_mutex_lock(&store_lock, K_FOREVER);
+
+    if (cur_count == CHUNK_POINTS) {
+        // Close the full chunk and open the next one
+        ret = write_cur_chunk();
+        if (ret != 0) {
+            goto out;
+        }
+
+        ret = open_next_chunk();
+        if (ret != 0) {
+            goto out;
+        }
+    }
+
+    cur[cur_count].boot = meta.boot;
+    cur[cur_count].cm = cm;
+    cur[cur_count].time_ms = time_ms;
+    cur_count++;
+    cur_dirty = true;
+
+    // Not rescheduled, so a steady stream of saves still gets written every period
+    k_work_schedule(&flush_work, K_MSEC(CONFIG_APP_POINT_STORE_FLUSH_MS));
+
+out:
+    k_mutex_unlock(&store_lock);
+    return ret;
+}
+
+size_t point_store_count(void)
+{
+    size_t count;
+
+    k_mutex_lock(&store_lock, K_FOREVER);
+    count = (size_t)(meta.cur_seq - meta.first_seq) * CHUNK_POINTS + cur_count;
+    k_mutex_unlock(&store_lock);
+
+    return count;
+}
+
+int point_store_get(size_t index, struct saved_point *point)
+{
+    uint32_t seq;
+    size_t offset;
+    int ret = 0;
+
+    k_mutex_lock(&store_lock, K_FOREVER);
+
+    seq = meta.first_seq + index / CHUNK_POINTS;
+    offset = index % CHUNK_POINTS;
+
+    if (seq == meta.cur_seq) {
+        if (offset < cur_count) {
+            *point = cur[offset];
+        } else {
+            ret = -ENOENT;
+        }
+    } else if (seq < meta.cur_seq) {
+        if (!cache_valid || cache_seq != seq) {
+            cache_valid = read_chunk(seq, cache) == CHUNK_POINTS;
+            cache_seq = seq;
+        }
+        if (cache_valid) {
+            *point = cache[offset];
+        } else {
+            ret = -EIO;
+        }
+    } else {
+        ret = -ENOENT;
+    }
+
+    k_mutex_unlock(&store_lock);
+    return ret;
+}
+
+int point_store_clear(void)
+{
+    int ret;
+
+    k_mutex_lock(&store_lock, K_FOREVER);
+
+    k_work_cancel_delayable(&flush_work);
+    for (uint32_t seq = meta.first_seq; seq <= meta.cur_seq; seq++) {
+        nvs_delete(&fs, CHUNK_ID(seq));
+    }
+
+    // Sequence numbers keep counting up so no stale entry can match a new chunk
+    meta.cur_seq++;
+    meta.first_seq = meta.cur_seq;
+    cur_count = 0;
+    cur_dirty = false;
+    cache_valid = false;
+    ret = write_meta();
+
+    k_mutex_unlock(&store_lock);
+    return ret;
+}
@@ -0,0 +1,35 @@
+#ifndef DISTANCE_DISPLAY_POINT_STORE_H_
+#define DISTANCE_DISPLAY_POINT_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct saved_point {
+    // Boot the point was saved in, counted by the store
+    uint16_t boot;
+    uint16_t cm;
+    // Uptime when the point was saved
+    uint32_t time_ms;
+};
+
+// Mount the storage partition. Only reads the index and the newest chunk, however many points
+// are stored.
+int point_store_init(void);
+
+// Queue a point. Points are written out in one flash write per
+// CONFIG_APP_POINT_STORE_FLUSH_MS or per full chunk, whichever comes first.
+int point_store_append(uint16_t cm, uint32_t time_ms);
+
+// Number of stored points, queued ones included
+size_t point_store_count(void);
+
+// Point by index, oldest first. Reading nearby indices in order only reads flash once per chunk.
+int point_store_get(size_t index, struct saved_point *point);
+
+// Delete every point
+int point_store_clear(void);
+
+// Write queued points now
+int point_store_flush(void);
+
+#endif
@@ -0,0 +1,75 @@
+#include "theme.h"
+
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+
+struct theme {
+    lv_color_t bg;
+    lv_color_t button_bg;
+    lv_color_t button_text;
+    lv_color_t text;
+    lv_color_t series;
+};
+
+// Palette colors as constants, lv_palette_main() can't be used in an initializer
+static const struct theme themes[] = {
+    [THEME_LIGHT] = {
+        .bg = LV_COLOR_MAKE(0xf0, 0xf0, 0xf0),
+        .button_bg = LV_COLOR_MAKE(0x03, 0xa9, 0xf4),    // light blue
+        .button_text = LV_COLOR_MAKE(0x00, 0x00, 0x00),
+        .text = LV_COLOR_MAKE(0x00, 0x00, 0x00),
+        .series = LV_COLOR_MAKE(0x21, 0x96, 0xf3),       // blue
+    },
+    [THEME_DARK] = {
+        .bg = LV_COLOR_MAKE(0x12, 0x12, 0x12),
+        .button_bg = LV_COLOR_MAKE(0x9e, 0x9e, 0x9e),    // grey
+        .button_text = LV_COLOR_MAKE(0xff, 0xff, 0xff),
+        .text = LV_COLOR_MAKE(0xff, 0xff, 0xff),
+        .series = LV_COLOR_MAKE(0xff, 0x98, 0x00),       // orange
+    },
+};
+
+lv_style_t theme_bg_style;
+lv_style_t theme_button_style;
+lv_style_t theme_text_style;
+
+static const struct theme *current = &themes[THEME_LIGHT];
+
+// Every property is set on every switch, so each style keeps the same properties and setting
+// one only overwrites its value
+static void theme_set_styles(const struct theme *t)
+{
+    lv_style_set_bg_color(&theme_bg_style, t->bg);
+    lv_style_set_bg_opa(&theme_bg_style, LV_OPA_COVER);
+
+    lv_style_set_bg_color(&theme_button_style, t->button_bg);
+    lv_style_set_text_color(&theme_button_style, t->button_text);
+
+    lv_style_set_text_color(&theme_text_style, t->text);
+}
+
+void theme_init(void)
+{
+    lv_style_init(&theme_bg_style);
+    lv_style_init(&theme_button_style);
+    lv_style_init(&theme_text_style);
+
+    theme_set_styles(current);
+}
+
+void theme_apply(enum theme_id id)
+{
+    __ASSERT_NO_MSG(id < ARRAY_SIZE(themes));
+
+    current = &themes[id];
+    theme_set_styles(current);
+
+    // A single refresh for all role styles. Reporting each style would walk the object tree
+    // once per style.
+    lv_obj_report_style_change(NULL);
+}
+
+lv_color_t theme_series_color(void)
+{
+    return current->series;
+}
@@ -0,0 +1,26 @@
+#ifndef DISTANCE_DISPLAY_THEME_H_
+#define DISTANCE_DISPLAY_THEME_H_
+
+#include <lvgl.h>
+
+enum theme_id {
+    THEME_LIGHT,
+    THEME_DARK,
+};
+
+// One style per role, shared by every object in that role on both screens. Switching themes
+// changes these styles in place, objects never have theme styles added or removed.
+extern lv_style_t theme_bg_style;
+extern lv_style_t theme_button_style;
+extern lv_style_t theme_text_style;
+
+// Initialize the role styles with the light theme, before any object uses them
+void theme_init(void);
+
+// Switch every object using the role styles to the theme
+void theme_apply(enum theme_id id);
+
+// Color of the chart's main series in the current theme
+lv_color_t theme_series_color(void);
+
+#endif
@@ -0,0 +1,116 @@
+#include "trend.h"
+
+#include <lvgl.h>
+#include <zephyr/sys/util.h>
+
+#define TREND_POINTS CONFIG_APP_TREND_POINTS
+
+// Bucket being accumulated for one rollup level
+struct trend_bucket {
+    int64_t start_ms;
+    int64_t sum;
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+};
+
+struct trend_level_desc {
+    const char *name;
+    // Bucket length, 0 for the raw level
+    uint32_t period_ms;
+};
+
+static const struct trend_level_desc levels[TREND_LEVEL_COUNT] = {
+    [TREND_RAW]  = { .name = "Live",  .period_ms = 0 },
+    [TREND_1S]   = { .name = "1 s",   .period_ms = 1000 },
+    [TREND_10S]  = { .name = "10 s",  .period_ms = 10000 },
+    [TREND_1MIN] = { .name = "1 min", .period_ms = 60000 },
+};
+
+static int32_t raw_values[TREND_POINTS];
+static int32_t rollup_values[TREND_LEVEL_COUNT - 1][3][TREND_POINTS];
+
+static struct trend_ring rings[TREND_LEVEL_COUNT];
+static struct trend_bucket buckets[TREND_LEVEL_COUNT];
+
+static void ring_push(struct trend_ring *ring, int32_t mean, int32_t min, int32_t max)
+{
+    ring->mean[ring->head] = mean;
+    if (ring->min != ring->mean) {
+        ring->min[ring->head] = min;
+        ring->max[ring->head] = max;
+    }
+    ring->head = (ring->head + 1) % TREND_POINTS;
+    ring->version++;
+}
+
+// Fold an already aggregated span starting at time_ms into level's bucket. A closed bucket is
+// pushed to the level's ring and folded into the next level, so one sample touches each level
+// at most once.
+static void bucket_add(enum trend_level level, int64_t time_ms, int32_t min, int32_t max,
+                       int64_t sum, uint32_t count)
+{
+    struct trend_bucket *b = &buckets[level];
+    uint32_t period = levels[level].period_ms;
+
+    if (b->count > 0 && time_ms - b->start_ms >= period) {
+        int32_t mean = (b->sum + b->count / 2) / b->count;
+
+        ring_push(&rings[level], mean, b->min, b->max);
+        if (level + 1 < TREND_LEVEL_COUNT) {
+            bucket_add(level + 1, b->start_ms, b->min, b->max, b->sum, b->count);
+        }
+        b->count = 0;
+    }
+
+    if (b->count == 0) {
+        // Buckets are aligned to their period so all levels line up
+        b->start_ms = time_ms - time_ms % period;
+        b->sum = 0;
+        b->min = min;
+        b->max = max;
+    }
+
+    b->sum += sum;
+    b->count += count;
+    b->min = MIN(b->min, min);
+    b->max = MAX(b->max, max);
+}
+
+void trend_init(void)
+{
+    for (int i = 0; i < TREND_POINTS; i++) {
+        raw_values[i] = LV_CHART_POINT_NONE;
+        for (int level = 0; level < TREND_LEVEL_COUNT - 1; level++) {
+            for (int k = 0; k < 3; k++) {
+                rollup_values[level][k][i] = LV_CHART_POINT_NONE;
+            }
+        }
+    }
+
+    rings[TREND_RAW].mean = raw_values;
+    rings[TREND_RAW].min = raw_values;
+    rings[TREND_RAW].max = raw_values;
+
+    for (int level = TREND_1S; level < TREND_LEVEL_COUNT; level++) {
+        rings[level].mean = rollup_values[level - 1][0];
+        rings[level].min = rollup_values[level - 1][1];
+        rings[level].max = rollup_values[level - 1][2];
+    }
+}
+
+void trend_add(int cm, int64_t time_ms)
+{
+    ring_push(&rings[TREND_RAW], cm, cm, cm);
+    bucket_add(TREND_1S, time_ms, cm, cm, cm, 1);
+}
+
+const struct trend_ring *trend_get(enum trend_level level)
+{
+    return &rings[level];
+}
+
+const char *trend_level_name(enum trend_level level)
+{
+    return levels[level].name;
+}
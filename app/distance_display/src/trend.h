@@ -0,0 +1,37 @@
+#ifndef DISTANCE_DISPLAY_TREND_H_
+#define DISTANCE_DISPLAY_TREND_H_
+
+#include <stdint.h>
+
+enum trend_level {
+    TREND_RAW,
+    TREND_1S,
+    TREND_10S,
+    TREND_1MIN,
+    TREND_LEVEL_COUNT,
+};
+
+// CONFIG_APP_TREND_POINTS values per level, in the layout lv_chart expects for an external
+// y array: unwritten slots hold LV_CHART_POINT_NONE and head is the x start point.
+struct trend_ring {
+    int32_t *mean;
+    // Same array as mean for TREND_RAW
+    int32_t *min;
+    int32_t *max;
+    // Next slot to be written, which is the oldest value once the ring is full
+    uint32_t head;
+    // Incremented on every write, so readers can tell whether anything changed
+    uint32_t version;
+};
+
+void trend_init(void);
+
+// Add a sample to the raw ring and the rollups, O(1) per sample
+void trend_add(int cm, int64_t time_ms);
+
+const struct trend_ring *trend_get(enum trend_level level);
+
+// Short name of the level for the zoom control
+const char *trend_level_name(enum trend_level level);
+
+#endif
@@ -0,0 +1,111 @@
+#include "units.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// value = (cm * num + den / 2) / den, so every unit rounds the same way on every screen
+struct unit_desc {
+    uint16_t num;
+    uint16_t den;
+    const char *suffix;
+};
+
+static const struct unit_desc unit_table[UNIT_COUNT] = {
+    [UNIT_CM]        = { .num = 1,   .den = 1,   .suffix = " cm" },
+    [UNIT_MM]        = { .num = 10,  .den = 1,   .suffix = " mm" },
+    [UNIT_INCH]      = { .num = 100, .den = 254, .suffix = " ''" },
+    [UNIT_FEET_INCH] = { .num = 100, .den = 254, .suffix = "''" },
+};
+
+int units_convert(int cm, enum distance_unit unit)
+{
+    const struct unit_desc *desc = &unit_table[unit];
+
+    if (cm < 0) {
+        cm = 0;
+    }
+
+    return ((uint32_t)cm * desc->num + desc->den / 2) / desc->den;
+}
+
+// Append the decimal digits of value at buf[pos], returns the new position
+static size_t append_uint(char *buf, size_t pos, unsigned int value)
+{
+    char digits[10];
+    int n = 0;
+
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (n > 0) {
+        buf[pos++] = digits[--n];
+    }
+
+    return pos;
+}
+
+static size_t append_str(char *buf, size_t pos, const char *str)
+{
+    size_t len = strlen(str);
+
+    memcpy(&buf[pos], str, len);
+    return pos + len;
+}
+
+int units_format(int cm, enum distance_unit unit, char *buf, size_t len)
+{
+    char tmp[UNITS_STR_LEN + 8];
+    int value = units_convert(cm, unit);
+    size_t pos = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    if (unit == UNIT_FEET_INCH) {
+        pos = append_uint(tmp, pos, value / 12);
+        pos = append_str(tmp, pos, "' ");
+        pos = append_uint(tmp, pos, value % 12);
+    } else {
+        pos = append_uint(tmp, pos, value);
+    }
+    pos = append_str(tmp, pos, unit_table[unit].suffix);
+
+    if (pos >= len) {
+        pos = len - 1;
+    }
+    memcpy(buf, tmp, pos);
+    buf[pos] = '\0';
+
+    return pos;
+}
+
+int units_format_rate(int cm_per_s, enum distance_unit unit, char *buf, size_t len)
+{
+    char tmp[UNITS_RATE_STR_LEN + 8];
+    size_t pos = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    // Magnitude rounds like a distance, a speed that rounds to 0 gets no sign
+    if (cm_per_s < 0 && units_convert(-cm_per_s, unit) != 0) {
+        tmp[pos++] = '-';
+        cm_per_s = -cm_per_s;
+    } else if (cm_per_s < 0) {
+        cm_per_s = 0;
+    }
+    pos += units_format(cm_per_s, unit, &tmp[pos], sizeof(tmp) - pos);
+    pos = append_str(tmp, pos, "/s");
+
+    if (pos >= len) {
+        pos = len - 1;
+    }
+    memcpy(buf, tmp, pos);
+    buf[pos] = '\0';
+
+    return pos;
+}
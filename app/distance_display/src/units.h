@@ -0,0 +1,29 @@
+#ifndef DISTANCE_DISPLAY_UNITS_H_
+#define DISTANCE_DISPLAY_UNITS_H_
+
+#include <stddef.h>
+
+enum distance_unit {
+    UNIT_CM,
+    UNIT_MM,
+    UNIT_INCH,
+    UNIT_FEET_INCH,
+    UNIT_COUNT,
+};
+
+// Longest string units_format() produces, including the terminator ("25' 1''" style)
+#define UNITS_STR_LEN 12
+
+// Longest string units_format_rate() produces, sign and "/s" included
+#define UNITS_RATE_STR_LEN (UNITS_STR_LEN + 3)
+
+// Distance in the smallest step of the unit (inches for UNIT_FEET_INCH), rounded half up
+int units_convert(int cm, enum distance_unit unit);
+
+// Format cm as text in the given unit without floats or printf. Returns the string length.
+int units_format(int cm, enum distance_unit unit, char *buf, size_t len);
+
+// Format a signed speed in cm/s as text in the given unit per second, e.g. "-12 cm/s"
+int units_format_rate(int cm_per_s, enum distance_unit unit, char *buf, size_t len);
+
+#endif
@@ -8,6 +8,9 @@
 
 #define MB7040_NODE DT_NODELABEL(mb70401)
 
+//how many 5 ms waits for a measurement before giving up on it, well past a range cycle
+#define MAX_RETRIES 100
+
 int main(void) 
 {
     struct sensor_value sensor_val; 
@@ -31,17 +34,20 @@ int main(void)
         ret = sensor_sample_fetch(sensor_dev);
         if (ret != 0) {
             printk("ERROR: Failed to fetch sample: %d\n", ret);
+            //nothing to wait for, try again later
+            k_msleep(100);
+            continue;
         }
 
-        //continuously try to get measurment untl its ready 
-        do {
+        //keep trying to get the measurement until its ready, other errors end the cycle
+        for (int retries = 0; retries < MAX_RETRIES; retries++) {
             ret = sensor_channel_get(sensor_dev, SENSOR_CHAN_DISTANCE, &sensor_val);
-            if (ret == -EAGAIN) {
-                //short wait for things to catch up
-                k_msleep(5);
+            if (ret != -EAGAIN) {
+                break;
             }
-
-        } while (ret != 0);
+            //short wait for things to catch up
+            k_msleep(5);
+        }
 
         if (ret != 0) {
             printk("ERROR: Failed to get channel: %d\n", ret);
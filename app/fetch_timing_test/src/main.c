@@ -0,0 +1,210 @@
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/ztest.h>
+#include <app/drivers/sensor/emul_mb7040.h>
+
+#define GPIO_NODE   DT_NODELABEL(mb7040_gpio)
+#define NOGPIO_NODE DT_NODELABEL(mb7040_nogpio)
+
+// Matches the driver's settle time between ranging done and the I2C read
+#define SETTLE_MS 10
+// Slack for tick rounding and the polling interval below
+#define TOLERANCE_MS 2
+#define BACK_TO_BACK_FETCHES 20
+// Farthest distance the emulator reports, bounds how long a leftover ranging can run
+#define MAX_RANGE_CM 765
+
+static const struct device *const gpio_sensor = DEVICE_DT_GET(GPIO_NODE);
+static const struct device *const nogpio_sensor = DEVICE_DT_GET(NOGPIO_NODE);
+static const struct emul *const gpio_emul = EMUL_DT_GET(GPIO_NODE);
+static const struct emul *const nogpio_emul = EMUL_DT_GET(NOGPIO_NODE);
+static const struct gpio_dt_spec status_gpio = GPIO_DT_SPEC_GET(GPIO_NODE, status_gpios);
+
+// Emulated ranging time for a distance, same model as the emulator
+static int64_t ranging_ms(uint16_t cm)
+{
+    return (CONFIG_EMUL_MB7040_OVERHEAD_US + cm * 20000 / 343 + 999) / 1000;
+}
+
+static int64_t fetch_timeout_ms(void)
+{
+    return CONFIG_MB7040_DELAY_MS + SETTLE_MS;
+}
+
+// Poll until the sample started by the last fetch lands, returns channel_get's result
+static int wait_sample(const struct device *dev, struct sensor_value *val, int64_t *elapsed_ms)
+{
+    int64_t start = k_uptime_get();
+    int ret;
+
+    do {
+        ret = sensor_channel_get(dev, SENSOR_CHAN_DISTANCE, val);
+        if (ret == -EAGAIN) {
+            k_usleep(100);
+        }
+    } while (ret == -EAGAIN && k_uptime_get() - start < 10 * fetch_timeout_ms());
+
+    *elapsed_ms = k_uptime_get() - start;
+    return ret;
+}
+
+ZTEST(mb7040_fetch_timing, test_gpio_fired)
+{
+    struct sensor_value val;
+    int64_t start, fetch_ms, elapsed;
+    int ret;
+
+    mb7040_emul_set_distance(gpio_emul, 200);
+
+    start = k_uptime_get();
+    ret = sensor_sample_fetch(gpio_sensor);
+    fetch_ms = k_uptime_get() - start;
+    zassert_ok(ret, "fetch returned %d", ret);
+    zassert_equal(fetch_ms, 0, "fetch blocked for %lld ms", fetch_ms);
+
+    ret = wait_sample(gpio_sensor, &val, &elapsed);
+    zassert_ok(ret, "channel_get returned %d", ret);
+    zassert_true(val.val1 == 2 && val.val2 == 0, "got %d.%06d m, expected 2.000000", val.val1,
+                 val.val2);
+    zassert_between_inclusive(elapsed, ranging_ms(200) + SETTLE_MS - 1,
+                              ranging_ms(200) + SETTLE_MS + TOLERANCE_MS,
+                              "sample took %lld ms, expected %lld", elapsed,
+                              ranging_ms(200) + SETTLE_MS);
+}
+
+ZTEST(mb7040_fetch_timing, test_gpio_timeout)
+{
+    struct sensor_value val;
+    int64_t elapsed;
+    int ret;
+
+    mb7040_emul_set_stuck(gpio_emul, true);
+
+    ret = sensor_sample_fetch(gpio_sensor);
+    zassert_ok(ret, "fetch returned %d", ret);
+
+    ret = wait_sample(gpio_sensor, &val, &elapsed);
+    zassert_equal(ret, -ETIMEDOUT, "channel_get returned %d, expected %d", ret, -ETIMEDOUT);
+    zassert_between_inclusive(elapsed, fetch_timeout_ms() - 1, fetch_timeout_ms() + TOLERANCE_MS,
+                              "timeout took %lld ms, expected %lld", elapsed, fetch_timeout_ms());
+}
+
+ZTEST(mb7040_fetch_timing, test_no_gpio_timeout_is_success)
+{
+    struct sensor_value val;
+    int64_t elapsed;
+    int ret;
+
+    mb7040_emul_set_distance(nogpio_emul, 150);
+
+    ret = sensor_sample_fetch(nogpio_sensor);
+    zassert_ok(ret, "fetch returned %d", ret);
+
+    ret = wait_sample(nogpio_sensor, &val, &elapsed);
+    zassert_ok(ret, "channel_get returned %d", ret);
+    zassert_true(val.val1 == 1 && val.val2 == 500000, "got %d.%06d m, expected 1.500000",
+                 val.val1, val.val2);
+    if (!IS_ENABLED(CONFIG_MB7040_ADAPTIVE_TIMING)) {
+        zassert_between_inclusive(elapsed, fetch_timeout_ms() - 1,
+                                  fetch_timeout_ms() + TOLERANCE_MS,
+                                  "sample took %lld ms, expected %lld", elapsed,
+                                  fetch_timeout_ms());
+    }
+}
+
+ZTEST(mb7040_fetch_timing, test_back_to_back_rate)
+{
+    struct sensor_value val;
+    int64_t start, elapsed, expected;
+    int ret;
+
+    mb7040_emul_set_distance(gpio_emul, 100);
+    expected = BACK_TO_BACK_FETCHES * (ranging_ms(100) + SETTLE_MS + TOLERANCE_MS);
+
+    start = k_uptime_get();
+    for (int i = 0; i < BACK_TO_BACK_FETCHES; i++) {
+        ret = sensor_sample_fetch(gpio_sensor);
+        zassert_ok(ret, "fetch %d returned %d", i, ret);
+        ret = wait_sample(gpio_sensor, &val, &elapsed);
+        zassert_ok(ret, "channel_get %d returned %d", i, ret);
+    }
+    elapsed = k_uptime_get() - start;
+
+    zassert_true(elapsed <= expected, "%d fetches took %lld ms, budget %lld ms",
+                 BACK_TO_BACK_FETCHES, elapsed, expected);
+    TC_PRINT("back-to-back: %d samples in %lld ms\n", BACK_TO_BACK_FETCHES, elapsed);
+}
+
+ZTEST(mb7040_fetch_timing, test_stale_edge_ignored)
+{
+    struct sensor_value val;
+    int64_t elapsed;
+    int ret;
+
+    mb7040_emul_set_distance(gpio_emul, 300);
+
+    // A leftover edge while idle must not complete the next fetch early
+    gpio_emul_input_set(status_gpio.port, status_gpio.pin, 1);
+    gpio_emul_input_set(status_gpio.port, status_gpio.pin, 0);
+
+    ret = sensor_sample_fetch(gpio_sensor);
+    zassert_ok(ret, "fetch returned %d", ret);
+
+    ret = wait_sample(gpio_sensor, &val, &elapsed);
+    zassert_ok(ret, "channel_get returned %d", ret);
+    zassert_true(val.val1 == 3 && val.val2 == 0, "got %d.%06d m, expected 3.000000", val.val1,
+                 val.val2);
+    zassert_true(elapsed >= ranging_ms(300) + SETTLE_MS - 1,
+                 "sample landed after %lld ms, before ranging could finish", elapsed);
+}
+
+ZTEST(mb7040_fetch_timing, test_irq_disabled_on_i2c_failure)
+{
+    struct sensor_value val;
+    uint32_t bytes;
+    int ret;
+
+    mb7040_emul_set_nack(gpio_emul, true);
+    ret = sensor_sample_fetch(gpio_sensor);
+    mb7040_emul_set_nack(gpio_emul, false);
+    zassert_equal(ret, -EIO, "fetch returned %d, expected %d", ret, -EIO);
+
+    ret = sensor_channel_get(gpio_sensor, SENSOR_CHAN_DISTANCE, &val);
+    zassert_equal(ret, -EIO, "channel_get returned %d, expected %d", ret, -EIO);
+
+    // With the interrupt left enabled this edge would trigger a read
+    bytes = mb7040_emul_get_bus_bytes(gpio_emul);
+    gpio_emul_input_set(status_gpio.port, status_gpio.pin, 1);
+    gpio_emul_input_set(status_gpio.port, status_gpio.pin, 0);
+    k_msleep(fetch_timeout_ms() + TOLERANCE_MS);
+    zassert_equal(mb7040_emul_get_bus_bytes(gpio_emul), bytes, "status edge caused bus traffic");
+
+    ret = sensor_channel_get(gpio_sensor, SENSOR_CHAN_DISTANCE, &val);
+    zassert_equal(ret, -EIO, "channel_get returned %d after stray edge", ret);
+}
+
+static void *fetch_timing_setup(void)
+{
+    zassert_true(device_is_ready(gpio_sensor), "%s not ready", gpio_sensor->name);
+    zassert_true(device_is_ready(nogpio_sensor), "%s not ready", nogpio_sensor->name);
+
+    return NULL;
+}
+
+// Leave both sensors idle with no fault injected, whatever the last test did
+static void fetch_timing_after(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    mb7040_emul_set_stuck(gpio_emul, false);
+    mb7040_emul_set_nack(gpio_emul, false);
+    mb7040_emul_set_nack(nogpio_emul, false);
+    k_msleep(MAX(ranging_ms(MAX_RANGE_CM), fetch_timeout_ms()) + TOLERANCE_MS);
+}
+
+ZTEST_SUITE(mb7040_fetch_timing, NULL, fetch_timing_setup, NULL, fetch_timing_after, NULL);
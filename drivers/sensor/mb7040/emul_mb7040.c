@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/logging/log.h>
+#include <app/drivers/sensor/emul_mb7040.h>
+
+#include "mb7040.h"
+
+#if MB7040_HAS_STATUS_GPIO
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#endif
+
+LOG_MODULE_REGISTER(emul_mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+/* Distance is reported in meters, same as the driver's decoder */
+#define MB7040_EMUL_SHIFT 3
+
+struct mb7040_emul_data {
+	/* Distance used when no waveform is set */
+	uint16_t distance_cm;
+	const struct mb7040_emul_point *waveform;
+	size_t waveform_len;
+	bool waveform_repeat;
+	int64_t waveform_start_ms;
+
+	/* Result latched by the last range command */
+	uint16_t result_cm;
+	/* Uptime in ticks until which the sensor is ranging and NACKs */
+	int64_t busy_until;
+	struct k_timer status_timer;
+
+	/* Injected faults */
+	bool nack_all;
+	bool stuck;
+
+	uint32_t bus_bytes;
+	uint32_t range_cmds;
+	uint32_t nacks;
+};
+
+struct mb7040_emul_cfg {
+	uint16_t addr;
+#if MB7040_HAS_STATUS_GPIO
+	struct gpio_dt_spec status_gpio;
+#endif
+};
+
+/* Distance at uptime @p now_ms, linearly interpolated along the waveform */
+static uint16_t mb7040_emul_distance_at(struct mb7040_emul_data *data, int64_t now_ms)
+{
+	const struct mb7040_emul_point *wf = data->waveform;
+	size_t len = data->waveform_len;
+	int64_t t;
+
+	if (wf == NULL || len == 0) {
+		return data->distance_cm;
+	}
+
+	t = now_ms - data->waveform_start_ms;
+	if (data->waveform_repeat && wf[len - 1].time_ms > 0) {
+		t %= wf[len - 1].time_ms;
+	}
+
+	if (t <= wf[0].time_ms) {
+		return wf[0].distance_cm;
+	}
+
+	for (size_t i = 1; i < len; i++) {
+		if (t < wf[i].time_ms) {
+			int32_t span = wf[i].time_ms - wf[i - 1].time_ms;
+			int32_t delta = (int32_t)wf[i].distance_cm - wf[i - 1].distance_cm;
+
+			return wf[i - 1].distance_cm + delta * (t - wf[i - 1].time_ms) / span;
+		}
+	}
+
+	return wf[len - 1].distance_cm;
+}
+
+/* Round trip time of flight at 343 m/s plus the fixed ranging overhead */
+static uint32_t mb7040_emul_ranging_us(uint16_t distance_cm)
+{
+	return CONFIG_EMUL_MB7040_OVERHEAD_US + (uint32_t)distance_cm * 20000U / 343U;
+}
+
+static void mb7040_emul_status_expiry(struct k_timer *timer)
+{
+#if MB7040_HAS_STATUS_GPIO
+	const struct emul *target = k_timer_user_data_get(timer);
+	const struct mb7040_emul_cfg *cfg = target->cfg;
+
+	if (cfg->status_gpio.port != NULL) {
+		/* Falling edge signals the result is ready */
+		gpio_emul_input_set(cfg->status_gpio.port, cfg->status_gpio.pin, 0);
+	}
+#else
+	ARG_UNUSED(timer);
+#endif
+}
+
+static void mb7040_emul_start_ranging(const struct emul *target)
+{
+	struct mb7040_emul_data *data = target->data;
+	uint32_t ranging_us;
+
+	data->result_cm = mb7040_emul_distance_at(data, k_uptime_get());
+	ranging_us = mb7040_emul_ranging_us(data->result_cm);
+	data->busy_until = k_uptime_ticks() + k_us_to_ticks_ceil64(ranging_us);
+	data->range_cmds++;
+
+#if MB7040_HAS_STATUS_GPIO
+	const struct mb7040_emul_cfg *cfg = target->cfg;
+
+	if (cfg->status_gpio.port != NULL) {
+		gpio_emul_input_set(cfg->status_gpio.port, cfg->status_gpio.pin, 1);
+	}
+#endif
+
+	if (data->stuck) {
+		/* Never finishes, status stays high and transfers keep being NACKed */
+		data->busy_until = INT64_MAX;
+		return;
+	}
+
+	k_timer_start(&data->status_timer, K_USEC(ranging_us), K_NO_WAIT);
+}
+
+void mb7040_emul_set_distance(const struct emul *target, uint16_t distance_cm)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	data->waveform = NULL;
+	data->waveform_len = 0;
+	data->distance_cm = distance_cm;
+}
+
+void mb7040_emul_set_waveform(const struct emul *target, const struct mb7040_emul_point *points,
+			      size_t count, bool repeat)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	data->waveform = points;
+	data->waveform_len = count;
+	data->waveform_repeat = repeat;
+	data->waveform_start_ms = k_uptime_get();
+}
+
+void mb7040_emul_set_nack(const struct emul *target, bool nack)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	data->nack_all = nack;
+}
+
+void mb7040_emul_set_stuck(const struct emul *target, bool stuck)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	data->stuck = stuck;
+	if (!stuck && data->busy_until == INT64_MAX) {
+		/* Let a hung range cycle finish now */
+		data->busy_until = 0;
+		k_timer_start(&data->status_timer, K_NO_WAIT, K_NO_WAIT);
+	}
+}
+
+uint32_t mb7040_emul_get_bus_bytes(const struct emul *target)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	return data->bus_bytes;
+}
+
+uint32_t mb7040_emul_get_range_count(const struct emul *target)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	return data->range_cmds;
+}
+
+uint32_t mb7040_emul_get_nack_count(const struct emul *target)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	return data->nacks;
+}
+
+static int mb7040_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+				int addr)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	ARG_UNUSED(addr);
+
+	for (int i = 0; i < num_msgs; i++) {
+		/* Address byte, NACKed or not */
+		data->bus_bytes++;
+
+		if (data->nack_all || k_uptime_ticks() < data->busy_until) {
+			/* The sensor does not answer while ranging */
+			data->nacks++;
+			return -EIO;
+		}
+
+		data->bus_bytes += msgs[i].len;
+
+		if ((msgs[i].flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+			if (msgs[i].len != 2) {
+				LOG_ERR("Unexpected read of %u bytes", msgs[i].len);
+				return -EIO;
+			}
+			msgs[i].buf[0] = data->result_cm >> 8;
+			msgs[i].buf[1] = data->result_cm & 0xff;
+		} else {
+			if (msgs[i].len != 1 || msgs[i].buf[0] != RANGE_CMD) {
+				LOG_ERR("Unexpected write of %u bytes", msgs[i].len);
+				return -EIO;
+			}
+			mb7040_emul_start_ranging(target);
+		}
+	}
+
+	return 0;
+}
+
+static const struct i2c_emul_api mb7040_emul_api_i2c = {
+	.transfer = mb7040_emul_transfer,
+};
+
+static int mb7040_emul_set_channel(const struct emul *target, struct sensor_chan_spec ch,
+				   const q31_t *value, int8_t shift)
+{
+	int64_t cm;
+
+	if (ch.chan_type != SENSOR_CHAN_DISTANCE) {
+		return -ENOTSUP;
+	}
+
+	/* Q31 meters with @p shift integer bits to cm */
+	cm = ((int64_t)*value * 100) >> (31 - shift);
+	mb7040_emul_set_distance(target, CLAMP(cm, 0, UINT16_MAX));
+
+	return 0;
+}
+
+static int mb7040_emul_get_sample_range(const struct emul *target, struct sensor_chan_spec ch,
+					q31_t *lower, q31_t *upper, q31_t *epsilon, int8_t *shift)
+{
+	ARG_UNUSED(target);
+
+	if (ch.chan_type != SENSOR_CHAN_DISTANCE) {
+		return -ENOTSUP;
+	}
+
+	/* 0 to 7.65 m in 1 cm steps */
+	*shift = MB7040_EMUL_SHIFT;
+	*lower = 0;
+	*upper = ((int64_t)765 << (31 - MB7040_EMUL_SHIFT)) / 100;
+	*epsilon = ((int64_t)1 << (31 - MB7040_EMUL_SHIFT)) / 100;
+
+	return 0;
+}
+
+static const struct emul_sensor_driver_api mb7040_emul_api_sensor = {
+	.set_channel = mb7040_emul_set_channel,
+	.get_sample_range = mb7040_emul_get_sample_range,
+};
+
+static int mb7040_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct mb7040_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	data->distance_cm = 0;
+	data->waveform = NULL;
+	data->waveform_len = 0;
+	data->result_cm = 0;
+	data->busy_until = 0;
+	data->bus_bytes = 0;
+	data->range_cmds = 0;
+	data->nacks = 0;
+	data->nack_all = false;
+	data->stuck = false;
+
+	k_timer_init(&data->status_timer, mb7040_emul_status_expiry, NULL);
+	k_timer_user_data_set(&data->status_timer, (void *)target);
+
+	return 0;
+}
+
+#define MB7040_EMUL(n)                                                                             \
+	static struct mb7040_emul_data mb7040_emul_data_##n;                                       \
+	static const struct mb7040_emul_cfg mb7040_emul_cfg_##n = {                                \
+		.addr = DT_INST_REG_ADDR(n),                                                       \
+		IF_ENABLED(DT_INST_NODE_HAS_PROP(n, status_gpios),                                 \
+		(.status_gpio = GPIO_DT_SPEC_INST_GET(n, status_gpios),)) };                       \
+	EMUL_DT_INST_DEFINE(n, mb7040_emul_init, &mb7040_emul_data_##n, &mb7040_emul_cfg_##n,      \
+			    &mb7040_emul_api_i2c, &mb7040_emul_api_sensor)
+
+DT_INST_FOREACH_STATUS_OKAY(MB7040_EMUL)
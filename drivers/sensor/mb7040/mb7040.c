@@ -6,60 +6,210 @@
 
 #define DT_DRV_COMPAT maxbotix_mb7040
 
-#include <zephyr/kernel.h>
-#include <zephyr/drivers/sensor.h>
-#include <zephyr/drivers/i2c.h>
-#include <zephyr/device.h>
+#include <stdlib.h>
 #include <zephyr/logging/log.h>
-#include <zephyr/drivers/gpio.h>
 
-#define RANGE_CMD              0x51
-#define MB7040_HAS_STATUS_GPIO DT_ANY_INST_HAS_PROP_STATUS_OKAY(status_gpios)
+#include "mb7040.h"
 
 LOG_MODULE_REGISTER(mb7040, CONFIG_SENSOR_LOG_LEVEL);
 
-struct mb7040_data {
-	uint16_t distance_cm;
-	struct k_sem read_sem;
 #if MB7040_HAS_STATUS_GPIO
-	struct gpio_callback gpio_cb;
+static void status_gpio_callback(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+{
+	struct mb7040_data *data = CONTAINER_OF(cb, struct mb7040_data, gpio_cb);
+	uint64_t edge_ns = mb7040_timestamp_ns();
+
+	if (!atomic_cas(&data->edge_state, MB7040_EDGE_WAIT, MB7040_EDGE_SEEN)) {
+		/* The timeout already claimed this cycle */
+		return;
+	}
+
+	/* Ranging is done, pull the read forward from the timeout to the settle time */
+	data->edge_ns = edge_ns;
+	mb7040_mark(data, MB7040_MARK_READY);
+	k_work_reschedule(&data->read_work, K_MSEC(MB7040_SETTLE_MS));
+}
 #endif
-};
 
-struct mb7040_config {
-	struct i2c_dt_spec i2c;
-#if MB7040_HAS_STATUS_GPIO
-	struct gpio_dt_spec status_gpio;
+void mb7040_range_complete(struct mb7040_data *data, int result)
+{
+#ifdef CONFIG_SENSOR_ASYNC_API
+	struct rtio_iodev_sqe *iodev_sqe = data->pending_sqe;
+	struct mb7040_encoded_data *edata = data->pending_buf;
+
+	data->pending_sqe = NULL;
+	data->pending_buf = NULL;
 #endif
-};
 
-#if MB7040_HAS_STATUS_GPIO
-static void status_gpio_callback(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
+	data->result = result;
+	mb7040_count_cycle(data, result, data->cycle_start_ticks);
+
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	/* Before going idle, a new request from here on must not be mistaken for this one */
+	mb7040_sched_done(data);
+#endif
+
+	atomic_set(&data->state, MB7040_STATE_IDLE);
+
+#ifdef CONFIG_PM_DEVICE_RUNTIME
+	if (data->pm_held) {
+		data->pm_held = false;
+		pm_device_runtime_put_async(data->dev, K_NO_WAIT);
+	}
+#endif
+
+#ifdef CONFIG_SENSOR_ASYNC_API
+	/* Completed after going idle so the consumer can resubmit from its callback */
+	if (iodev_sqe != NULL) {
+		mb7040_submit_complete(data, iodev_sqe, edata, result);
+	}
+#endif
+
+#ifdef CONFIG_MB7040_STREAM
+	mb7040_stream_push(data, result);
+#endif
+
+#ifdef CONFIG_MB7040_TRIGGER
+	mb7040_trigger_check(data, result);
+#endif
+
+#ifdef CONFIG_SENSOR_ASYNC_API
+	/* Not started from here, a failing start would recurse once per queued request */
+	if (atomic_get(&data->sqe_queued) != 0) {
+		k_work_submit(&data->sqe_work);
+	}
+#endif
+}
+
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+/* Stretch the background period exponentially while the distance stays put */
+static void mb7040_duty_update(struct mb7040_data *data, uint16_t distance_cm)
 {
-	struct mb7040_data *data = CONTAINER_OF(cb, struct mb7040_data, gpio_cb);
+	if (abs((int)distance_cm - data->duty_ref_cm) > CONFIG_MB7040_DUTY_CYCLE_THRESHOLD_CM) {
+		/* Something moved, back to the full rate right away */
+		data->duty_ref_cm = distance_cm;
+		data->duty_us = 0;
+		return;
+	}
 
-	k_sem_give(&data->read_sem);
+	data->duty_us = CLAMP(data->duty_us * 2U, CONFIG_MB7040_DUTY_CYCLE_STEP_MS * 1000U,
+			      CONFIG_MB7040_DUTY_CYCLE_MAX_MS * 1000U);
 }
 #endif
 
-static int mb7040_sample_fetch(const struct device *dev, enum sensor_channel chan)
+/* Store a new sample and update everything derived from it */
+void mb7040_sample_update(struct mb7040_data *data, uint16_t distance_cm, uint64_t timestamp_ns)
+{
+	distance_cm = MIN(distance_cm, data->max_range_cm);
+
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+	/* Ahead of the filter, a median window would hold a step back over stretched periods */
+	mb7040_duty_update(data, distance_cm);
+#endif
+
+#ifdef CONFIG_MB7040_FILTER
+	/* Every consumer from here on, including the velocity filter, only sees filtered distances */
+	distance_cm = mb7040_filter_apply(&data->filter, distance_cm, timestamp_ns);
+#endif
+
+	data->distance_cm = distance_cm;
+	data->timestamp_ns = timestamp_ns;
+
+#ifdef CONFIG_MB7040_VELOCITY
+	mb7040_velocity_update(&data->velocity, distance_cm, timestamp_ns);
+#endif
+}
+
+/* Time left until the next background cycle is due, counted from the start of the last one */
+k_timeout_t mb7040_next_cycle_delay(struct mb7040_data *data, uint32_t default_us)
+{
+	uint32_t period_us = data->period_us != 0 ? data->period_us : default_us;
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+	period_us = MAX(period_us, data->duty_us);
+#endif
+	int64_t next = data->cycle_start_ticks + k_us_to_ticks_ceil64(period_us);
+	int64_t now = k_uptime_ticks();
+
+	return next > now ? K_TICKS(next - now) : K_NO_WAIT;
+}
+
+static void mb7040_read_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct mb7040_data *data = CONTAINER_OF(dwork, struct mb7040_data, read_work);
+	const struct mb7040_config *cfg = (struct mb7040_config *)data->dev->config;
+	uint8_t read_data[2];
+	uint16_t distance_cm;
+	uint64_t timestamp_ns;
+	int ret;
+
+#if MB7040_HAS_STATUS_GPIO
+	/* Check if status_gpio port is present */
+	if (cfg->status_gpio.port != NULL) {
+		gpio_pin_interrupt_configure_dt(&cfg->status_gpio, GPIO_INT_DISABLE);
+		if (atomic_cas(&data->edge_state, MB7040_EDGE_WAIT, MB7040_EDGE_DONE)) {
+			LOG_ERR("Status GPIO timed out");
+			mb7040_range_complete(data, -ETIMEDOUT);
+			return;
+		}
+		/*
+		 * An edge that came in while this ran as the timeout has queued its own read,
+		 * leave the cycle to that one. Anything else already finished its cycle.
+		 */
+		if (k_work_delayable_is_pending(&data->read_work) ||
+		    !atomic_cas(&data->edge_state, MB7040_EDGE_SEEN, MB7040_EDGE_DONE)) {
+			return;
+		}
+	}
+#endif
+
+	mb7040_mark(data, MB7040_MARK_READ);
+	ret = i2c_read_dt(&cfg->i2c, read_data, 2);
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+	if (ret == -EIO && mb7040_use_adaptive(cfg) && k_uptime_ticks() < data->deadline_ticks) {
+		/* Sensor NACKs while it is still ranging, back off and try again */
+		k_work_reschedule(&data->read_work, K_USEC(data->poll_us));
+		data->poll_us = MIN(data->poll_us * 2U, CONFIG_MB7040_ADAPTIVE_POLL_MAX_US);
+		return;
+	}
+#endif
+	if (ret != 0) {
+		LOG_ERR("I2C read failed with error %d", ret);
+		mb7040_count_i2c_error(data);
+		mb7040_range_complete(data, ret);
+		return;
+	}
+	mb7040_mark(data, MB7040_MARK_DONE);
+
+	/* Convert MSB/LSB to distance in cm */
+	distance_cm = (read_data[0] << 8) | read_data[1];
+#if MB7040_HAS_STATUS_GPIO
+	if (cfg->status_gpio.port != NULL) {
+		/* The echo completed at the edge, not when this work item got to run */
+		timestamp_ns = data->edge_ns;
+	} else {
+		timestamp_ns = mb7040_timestamp_ns();
+	}
+#else
+	timestamp_ns = mb7040_timestamp_ns();
+#endif
+	mb7040_sample_update(data, distance_cm, timestamp_ns);
+	mb7040_range_complete(data, 0);
+}
+
+int mb7040_range_fire(const struct device *dev)
 {
 	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
 	struct mb7040_data *data = (struct mb7040_data *)dev->data;
 	uint8_t cmd = RANGE_CMD;
 	int ret;
-	uint8_t read_data[2];
 
-	if (chan != SENSOR_CHAN_DISTANCE && chan != SENSOR_CHAN_ALL) {
-		LOG_ERR("Sensor only supports distance");
-		return -EINVAL;
-	}
-
-	k_sem_reset(&data->read_sem);
+	data->cycle_start_ticks = k_uptime_ticks();
 
 #if MB7040_HAS_STATUS_GPIO
 	/* Check if status_gpio port is present */
 	if (cfg->status_gpio.port != NULL) {
+		atomic_set(&data->edge_state, MB7040_EDGE_WAIT);
 		/* Enable interrupt before writing */
 		ret = gpio_pin_interrupt_configure_dt(&cfg->status_gpio, GPIO_INT_EDGE_FALLING);
 		if (ret != 0) {
@@ -70,9 +220,11 @@ static int mb7040_sample_fetch(const struct device *dev, enum sensor_channel cha
 #endif
 
 	/* Write range command to sensor */
+	mb7040_mark(data, MB7040_MARK_WRITE);
 	ret = i2c_write_dt(&cfg->i2c, &cmd, 1);
 	if (ret != 0) {
 		LOG_ERR("I2C write failed with error %d", ret);
+		mb7040_count_i2c_error(data);
 #if MB7040_HAS_STATUS_GPIO
 		/* Disable interrupt before returning error*/
 		if (cfg->status_gpio.port != NULL) {
@@ -81,62 +233,83 @@ static int mb7040_sample_fetch(const struct device *dev, enum sensor_channel cha
 #endif
 		return ret;
 	}
+	mb7040_mark(data, MB7040_MARK_WRITTEN);
+
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+	if (mb7040_use_adaptive(cfg)) {
+		uint32_t predict_us = mb7040_predict_us(data);
+
+		/* Start polling just before the predicted ready time, give up at the fixed delay */
+		data->poll_us = CONFIG_MB7040_ADAPTIVE_POLL_US;
+		data->deadline_ticks = k_uptime_ticks() +
+				       k_ms_to_ticks_ceil64(data->delay_ms + MB7040_SETTLE_MS);
+		k_work_reschedule(&data->read_work,
+				  K_USEC(predict_us > data->poll_us ? predict_us - data->poll_us : 0));
+		return 0;
+	}
+#endif
 
-	ret = k_sem_take(&data->read_sem, K_MSEC(CONFIG_MB7040_DELAY_MS));
+	/*
+	 * Without a status GPIO this is when the measurement is assumed done. With one,
+	 * the falling edge reschedules the read earlier and this acts as the timeout.
+	 */
+	k_work_reschedule(&data->read_work, K_MSEC(data->delay_ms + MB7040_SETTLE_MS));
 
-#if MB7040_HAS_STATUS_GPIO
-	/* Check if status_gpio port is present */
-	if (cfg->status_gpio.port != NULL) {
-		gpio_pin_interrupt_configure_dt(&cfg->status_gpio, GPIO_INT_DISABLE);
-		if (ret == 0) {
-			/* Success: interrupt fired and semaphore taken */
-		} else if (ret == -EAGAIN) {
-			LOG_ERR("Semaphore take timed out");
-			return -EAGAIN;
-		} else {
-			return ret;
-		}
-	} else {
-		if (ret == 0) {
-			/* Should not happen: semaphore only given by GPIO interrupt */
-			LOG_ERR("Semaphore taken unexpectedly without status GPIO");
-			return 0;
-		} else if (ret == -EAGAIN) {
-			/* Timeout is expected: treat as success */
-		} else {
-			return ret;
-		}
+	return 0;
+}
+
+int mb7040_range_start(const struct device *dev)
+{
+	if (mb7040_is_suspended(dev)) {
+		return -EBUSY;
 	}
-#else
-	if (ret == 0) {
-		/* Should not happen: semaphore only given by GPIO interrupt */
-		LOG_ERR("Semaphore taken unexpectedly without status GPIO");
-		return 0;
-	} else if (ret == -EAGAIN) {
-		/* Timeout is expected: treat as success */
-	} else {
+
+#ifdef CONFIG_PM_DEVICE_RUNTIME
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	int ret = pm_device_runtime_get(dev);
+
+	if (ret < 0) {
+		LOG_ERR("Failed to resume: %d", ret);
 		return ret;
 	}
+	/* Released by mb7040_range_complete() */
+	data->pm_held = true;
 #endif
 
-	k_msleep(10);
-	/* Small wait due to device specific internal i2c timings. 10ms is a common wait 
-	to time to ensure ultrasonic sensors achieve stability and accuracy*/
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	/* Fired by the bus scheduler in this instance's firing group slot */
+	return mb7040_sched_request(dev);
+#else
+	return mb7040_range_fire(dev);
+#endif
+}
 
-	ret = i2c_read_dt(&cfg->i2c, read_data, 2);
+static int mb7040_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	int ret;
 
+	if (chan != SENSOR_CHAN_DISTANCE && chan != SENSOR_CHAN_ALL) {
+		LOG_ERR("Sensor only supports distance");
+		return -EINVAL;
+	}
+
+	if (mb7040_is_background(data)) {
+		/* Background ranging keeps the latest sample fresh */
+		return 0;
+	}
+
+	if (!atomic_cas(&data->state, MB7040_STATE_IDLE, MB7040_STATE_RANGING)) {
+		/* Previous range cycle still in progress */
+		return -EBUSY;
+	}
+
+	ret = mb7040_range_start(dev);
 	if (ret != 0) {
-		LOG_ERR("I2C read failed with error %d", ret);
-#if MB7040_HAS_STATUS_GPIO
-		if (cfg->status_gpio.port != NULL) {
-			gpio_pin_interrupt_configure_dt(&cfg->status_gpio, GPIO_INT_DISABLE);
-		}
-#endif
+		mb7040_range_complete(data, ret);
 		return ret;
 	}
 
-	/* Convert MSB/LSB to distance in cm */
-	data->distance_cm = (read_data[0] << 8) | read_data[1];
 	return 0;
 }
 
@@ -145,32 +318,222 @@ static int mb7040_channel_get(const struct device *dev, enum sensor_channel chan
 {
 	struct mb7040_data *data = (struct mb7040_data *)dev->data;
 
-	if (chan != SENSOR_CHAN_DISTANCE) {
-		LOG_ERR("Sensor only supports distance");
+	switch ((int)chan) {
+	case SENSOR_CHAN_DISTANCE:
+	case SENSOR_CHAN_MB7040_TIMESTAMP:
+#ifdef CONFIG_MB7040_VELOCITY
+	case SENSOR_CHAN_MB7040_VELOCITY:
+#endif
+		break;
+	default:
+		LOG_ERR("Unsupported channel %d", chan);
 		return -ENOTSUP;
 	}
 
-	val->val1 = data->distance_cm;
-	val->val2 = 0;
+	if (atomic_get(&data->state) == MB7040_STATE_RANGING && !mb7040_is_background(data)) {
+		/* New sample has not landed yet */
+		return -EAGAIN;
+	}
+
+	if (data->result != 0) {
+		return data->result;
+	}
+
+	if (chan == (enum sensor_channel)SENSOR_CHAN_MB7040_TIMESTAMP) {
+		/* Seconds and microseconds on the mb7040_timestamp_ns() time base */
+		val->val1 = data->timestamp_ns / NSEC_PER_SEC;
+		val->val2 = (data->timestamp_ns % NSEC_PER_SEC) / NSEC_PER_USEC;
+		return 0;
+	}
+
+#ifdef CONFIG_MB7040_VELOCITY
+	if (chan == (enum sensor_channel)SENSOR_CHAN_MB7040_VELOCITY) {
+		mb7040_velocity_get(&data->velocity, val);
+		return 0;
+	}
+#endif
+
+	/* Distance channel is in meters, same as the async decoder */
+	val->val1 = data->distance_cm / 100;
+	val->val2 = (data->distance_cm % 100) * 10000;
 	return 0;
 }
 
+static int mb7040_attr_set(const struct device *dev, enum sensor_channel chan,
+			   enum sensor_attribute attr, const struct sensor_value *val)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	int64_t value;
+
+	if (chan != SENSOR_CHAN_DISTANCE && chan != SENSOR_CHAN_ALL) {
+		return -ENOTSUP;
+	}
+
+	switch ((int)attr) {
+	case SENSOR_ATTR_SAMPLING_FREQUENCY:
+		/* Hz to a period in us, 0 Hz restores the default rate */
+		value = (int64_t)val->val1 * 1000000 + val->val2;
+		if (value < 0) {
+			return -EINVAL;
+		}
+		data->period_us = value == 0 ? 0 : MIN(1000000000000LL / value, UINT32_MAX);
+		return 0;
+	case SENSOR_ATTR_MB7040_MAX_RANGE:
+		/* Meters to cm, same as the distance channel */
+		value = (int64_t)val->val1 * 100 + val->val2 / 10000;
+		if (value <= 0) {
+			return -EINVAL;
+		}
+		data->max_range_cm = MIN(value, MB7040_MAX_RANGE_CM);
+		return 0;
+	case SENSOR_ATTR_MB7040_READ_DELAY:
+		/* Seconds to ms, rounded up so a short delay never becomes none */
+		value = ((int64_t)val->val1 * 1000000 + val->val2 + 999) / 1000;
+		if (value <= 0 || value > UINT16_MAX) {
+			return -EINVAL;
+		}
+		data->delay_ms = value;
+		return 0;
+#ifdef CONFIG_MB7040_TRIGGER
+	case SENSOR_ATTR_UPPER_THRESH:
+	case SENSOR_ATTR_LOWER_THRESH:
+	case SENSOR_ATTR_HYSTERESIS:
+		return mb7040_trigger_attr_set(dev, attr, val);
+#endif
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static int mb7040_attr_get(const struct device *dev, enum sensor_channel chan,
+			   enum sensor_attribute attr, struct sensor_value *val)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	if (chan != SENSOR_CHAN_DISTANCE && chan != SENSOR_CHAN_ALL) {
+		return -ENOTSUP;
+	}
+
+	switch ((int)attr) {
+	case SENSOR_ATTR_SAMPLING_FREQUENCY:
+		if (data->period_us == 0) {
+			val->val1 = 0;
+			val->val2 = 0;
+		} else {
+			val->val1 = USEC_PER_SEC / data->period_us;
+			val->val2 = (uint64_t)(USEC_PER_SEC % data->period_us) * 1000000U /
+				    data->period_us;
+		}
+		return 0;
+	case SENSOR_ATTR_MB7040_MAX_RANGE:
+		val->val1 = data->max_range_cm / 100;
+		val->val2 = (data->max_range_cm % 100) * 10000;
+		return 0;
+	case SENSOR_ATTR_MB7040_READ_DELAY:
+		val->val1 = data->delay_ms / 1000;
+		val->val2 = (data->delay_ms % 1000) * 1000;
+		return 0;
+#ifdef CONFIG_MB7040_TRIGGER
+	case SENSOR_ATTR_UPPER_THRESH:
+	case SENSOR_ATTR_LOWER_THRESH:
+	case SENSOR_ATTR_HYSTERESIS:
+		return mb7040_trigger_attr_get(dev, attr, val);
+#endif
+	default:
+		return -ENOTSUP;
+	}
+}
+
 static DEVICE_API(sensor, mb7040_api) = {
 	.sample_fetch = mb7040_sample_fetch,
 	.channel_get = mb7040_channel_get,
+	.attr_set = mb7040_attr_set,
+	.attr_get = mb7040_attr_get,
+#ifdef CONFIG_MB7040_TRIGGER
+	.trigger_set = mb7040_trigger_set,
+#endif
+#ifdef CONFIG_SENSOR_ASYNC_API
+	.submit = mb7040_submit,
+	.get_decoder = mb7040_get_decoder,
+#endif
 };
 
+#ifdef CONFIG_PM_DEVICE
+/* Restart background ranging that stopped while the device was suspended */
+static void mb7040_background_resume(struct mb7040_data *data)
+{
+#ifdef CONFIG_MB7040_STREAM
+	if (mb7040_is_streaming(data)) {
+		k_work_reschedule(&data->stream.work, K_NO_WAIT);
+	}
+#endif
+#ifdef CONFIG_MB7040_TRIGGER
+	if (atomic_get(&data->trigger.armed)) {
+		k_work_reschedule(&data->trigger.work, K_NO_WAIT);
+	}
+#endif
+	ARG_UNUSED(data);
+}
+
+static int mb7040_pm_action(const struct device *dev, enum pm_device_action action)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	switch (action) {
+	case PM_DEVICE_ACTION_SUSPEND:
+		/*
+		 * The sensor has no sleep mode, suspending only stops the driver from
+		 * starting range cycles. Let a running cycle finish first.
+		 */
+		if (atomic_get(&data->state) == MB7040_STATE_RANGING) {
+			return -EBUSY;
+		}
+		return 0;
+	case PM_DEVICE_ACTION_RESUME:
+		if (!pm_device_runtime_is_enabled(dev)) {
+			mb7040_background_resume(data);
+		}
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+#endif
+
 static int mb7040_init(const struct device *dev)
 {
 	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
 	struct mb7040_data *data = (struct mb7040_data *)dev->data;
 
-	k_sem_init(&data->read_sem, 0, 1);
+	data->dev = dev;
+	data->max_range_cm = MB7040_MAX_RANGE_CM;
+	data->delay_ms = CONFIG_MB7040_DELAY_MS;
+	atomic_set(&data->state, MB7040_STATE_IDLE);
+	k_work_init_delayable(&data->read_work, mb7040_read_work_handler);
+#ifdef CONFIG_SENSOR_ASYNC_API
+	mb7040_submit_init(data);
+#endif
+#ifdef CONFIG_MB7040_STREAM
+	mb7040_stream_init(data);
+#endif
+#ifdef CONFIG_MB7040_TRIGGER
+	mb7040_trigger_init(data);
+#endif
 
 	if (!i2c_is_ready_dt(&cfg->i2c)) {
 		LOG_ERR("I2C not ready!");
 		return -ENODEV;
 	}
+
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	int err = mb7040_sched_register(dev);
+
+	if (err < 0) {
+		LOG_ERR("Failed to register with bus scheduler: %d", err);
+		return err;
+	}
+#endif
+
 	/* Initialize status GPIO if present */
 #if MB7040_HAS_STATUS_GPIO
 	if (cfg->status_gpio.port != NULL) {
@@ -200,7 +563,12 @@ static int mb7040_init(const struct device *dev)
 #else
 	LOG_INF("MB7040 initialized");
 #endif
+
+#ifdef CONFIG_PM_DEVICE
+	return pm_device_driver_init(dev, mb7040_pm_action);
+#else
 	return 0;
+#endif
 }
 
 #define MB7040_DEFINE(inst)                                                                        \
@@ -210,9 +578,12 @@ static int mb7040_init(const struct device *dev)
 	static const struct mb7040_config mb7040_config_##inst = {                                 \
 		.i2c = I2C_DT_SPEC_INST_GET(inst),                                                 \
 		IF_ENABLED(DT_INST_NODE_HAS_PROP(inst, status_gpios),                              \
-		(.status_gpio = GPIO_DT_SPEC_INST_GET(inst, status_gpios),)) };                    \
-	SENSOR_DEVICE_DT_INST_DEFINE(inst, mb7040_init, NULL, &mb7040_data_##inst,                 \
-				     &mb7040_config_##inst, POST_KERNEL,                           \
+		(.status_gpio = GPIO_DT_SPEC_INST_GET(inst, status_gpios),))                       \
+		IF_ENABLED(CONFIG_MB7040_BUS_SCHEDULER,                                            \
+		(.firing_group = DT_INST_PROP(inst, firing_group),)) };                            \
+	PM_DEVICE_DT_INST_DEFINE(inst, mb7040_pm_action);                                          \
+	SENSOR_DEVICE_DT_INST_DEFINE(inst, mb7040_init, PM_DEVICE_DT_INST_GET(inst),               \
+				     &mb7040_data_##inst, &mb7040_config_##inst, POST_KERNEL,      \
 				     CONFIG_SENSOR_INIT_PRIORITY, &mb7040_api);
 
 DT_INST_FOREACH_STATUS_OKAY(MB7040_DEFINE)
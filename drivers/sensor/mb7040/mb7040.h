@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_SENSOR_MB7040_MB7040_H_
+#define ZEPHYR_DRIVERS_SENSOR_MB7040_MB7040_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/mpsc_lockfree.h>
+#include <zephyr/sys/slist.h>
+#include <app/drivers/sensor/mb7040.h>
+
+#define RANGE_CMD              0x51
+#define MB7040_HAS_STATUS_GPIO DT_ANY_INST_HAS_PROP_STATUS_OKAY(status_gpios)
+
+/* Settle time between the end of ranging and the I2C read. 10ms is a common wait
+ * time to ensure ultrasonic sensors achieve stability and accuracy
+ */
+#define MB7040_SETTLE_MS 10
+
+/* Largest distance the sensor reports */
+#define MB7040_MAX_RANGE_CM 765
+
+/* Time base of every sample timestamp, cycle counter resolution where available, ticks otherwise */
+static inline uint64_t mb7040_timestamp_ns(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+	return k_cyc_to_ns_floor64(k_cycle_get_64());
+#else
+	return k_ticks_to_ns_floor64(k_uptime_ticks());
+#endif
+}
+
+enum mb7040_state {
+	/* No ranging in progress, last result (if any) is valid */
+	MB7040_STATE_IDLE,
+	/* Range command sent, waiting for the read work item to complete */
+	MB7040_STATE_RANGING,
+};
+
+#if MB7040_HAS_STATUS_GPIO
+/* Who gets to finish a range cycle that waits on the status GPIO */
+enum mb7040_edge_state {
+	/* Ranging, the falling edge and the timeout race to claim the cycle */
+	MB7040_EDGE_WAIT,
+	/* The edge won, its read is scheduled after the settle time */
+	MB7040_EDGE_SEEN,
+	/* Claimed by a read or the timeout, late runs of the read work item return */
+	MB7040_EDGE_DONE,
+};
+#endif
+
+/* One sample as handed to RTIO consumers, decoded by mb7040_decoder.c */
+struct mb7040_encoded_data {
+	uint64_t timestamp_ns;
+	uint16_t distance_cm;
+} __packed;
+
+#ifdef CONFIG_MB7040_STREAM
+/* Single producer (read work item), single consumer (mb7040_stream_read) ring */
+struct mb7040_stream {
+	struct mb7040_sample ring[CONFIG_MB7040_STREAM_RING_DEPTH];
+	/* Free running indices, head is written by the producer, tail by the consumer */
+	atomic_t head;
+	atomic_t tail;
+	/* Samples lost since the last queued one, producer only */
+	uint32_t dropped;
+	atomic_t enabled;
+	struct k_work_delayable work;
+};
+#endif
+
+#ifdef CONFIG_MB7040_TRIGGER
+/* Where the distance is relative to the threshold band */
+enum mb7040_zone {
+	MB7040_ZONE_INSIDE,
+	MB7040_ZONE_BELOW,
+	MB7040_ZONE_ABOVE,
+};
+
+/* Threshold trigger and the background ranging that feeds it */
+struct mb7040_trigger {
+	sensor_trigger_handler_t handler;
+	const struct sensor_trigger *trig;
+	/* Band in cm, set through SENSOR_ATTR_{UPPER,LOWER}_THRESH and _HYSTERESIS */
+	uint16_t upper_cm;
+	uint16_t lower_cm;
+	uint16_t hyst_cm;
+	/* Zone of the last sample, only reported when it changes */
+	enum mb7040_zone zone;
+	atomic_t armed;
+	struct k_work_delayable work;
+};
+#endif
+
+#ifdef CONFIG_MB7040_FILTER
+/* Per instance state of the sample filter stages, fixed size */
+struct mb7040_filter {
+#ifdef CONFIG_MB7040_FILTER_MEDIAN
+	/* Window in arrival order, median_next is the oldest once full */
+	uint16_t median_fifo[CONFIG_MB7040_FILTER_MEDIAN_WINDOW];
+	/* Same samples kept sorted */
+	uint16_t median_sorted[CONFIG_MB7040_FILTER_MEDIAN_WINDOW];
+	uint8_t median_count;
+	uint8_t median_next;
+#endif
+#ifdef CONFIG_MB7040_FILTER_EMA
+	/* Average in 1/256 cm */
+	int32_t ema_q8;
+#endif
+	/* Slew limited output and time of the previous sample */
+	uint16_t last_cm;
+	uint64_t last_ns;
+	bool valid;
+};
+#endif
+
+#ifdef CONFIG_MB7040_VELOCITY
+/* Alpha-beta filter state, updated from every successful sample */
+struct mb7040_velocity {
+	/* Filtered distance in micrometers */
+	int64_t x_um;
+	/* Filtered velocity in micrometers per second, positive when moving away */
+	int64_t v_ums;
+	/* Timestamp of the last sample the filter took */
+	uint64_t last_ns;
+	bool valid;
+};
+#endif
+
+/* Boundaries of the phases of a range cycle, MB7040_MARK_n starts MB7040_PHASE_n */
+enum mb7040_mark {
+	/* Range command about to be written */
+	MB7040_MARK_WRITE,
+	/* Range command written, sensor ranging */
+	MB7040_MARK_WRITTEN,
+	/* Status GPIO dropped, only with a status GPIO */
+	MB7040_MARK_READY,
+	/* Result read about to start */
+	MB7040_MARK_READ,
+	/* Result read */
+	MB7040_MARK_DONE,
+	MB7040_MARK_COUNT,
+};
+
+#ifdef CONFIG_MB7040_STATS
+/* Duration statistics of one phase, in ns */
+struct mb7040_phase_counter {
+	uint32_t count;
+	uint32_t min_ns;
+	uint32_t max_ns;
+	uint64_t sum_ns;
+};
+
+/* Raw counters behind mb7040_stats_get() */
+struct mb7040_counters {
+	uint32_t fetches;
+	uint32_t errors;
+	uint32_t timeouts;
+	uint32_t i2c_errors;
+	/* Successful cycles, the latency sum covers these */
+	uint32_t samples;
+	uint64_t latency_sum_us;
+	uint32_t latency_max_us;
+	struct mb7040_phase_counter phase[MB7040_PHASE_COUNT];
+};
+#endif
+
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+/* Serializes ranging of all instances sharing one I2C bus, group by group */
+struct mb7040_sched {
+	const struct device *bus;
+	sys_slist_t members;
+	/* Firing group that ranged last */
+	int group;
+	/*
+	 * Members of the current group that have not been read yet, plus one while the work
+	 * handler fires a group or a burst holds the bus
+	 */
+	atomic_t outstanding;
+	struct k_work_delayable work;
+};
+#endif
+
+struct mb7040_data {
+	const struct device *dev;
+	uint16_t distance_cm;
+	/* Time in ns at which the echo of distance_cm completed, read time without status GPIO */
+	uint64_t timestamp_ns;
+	/* Result of the last completed range cycle, returned by channel_get */
+	int result;
+	atomic_t state;
+	/* Uptime at which the current or last range cycle started */
+	int64_t cycle_start_ticks;
+	/* Background ranging period set with SENSOR_ATTR_SAMPLING_FREQUENCY, 0 for the default */
+	uint32_t period_us;
+	/* Set with SENSOR_ATTR_MB7040_MAX_RANGE */
+	uint16_t max_range_cm;
+	/* Set with SENSOR_ATTR_MB7040_READ_DELAY, CONFIG_MB7040_DELAY_MS by default */
+	uint32_t delay_ms;
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+	/* Background period stretch while readings are stable, 0 when they just changed */
+	uint32_t duty_us;
+	/* Distance the stretch is measured against */
+	uint16_t duty_ref_cm;
+#endif
+#ifdef CONFIG_PM_DEVICE_RUNTIME
+	/* The current range cycle holds a runtime PM reference */
+	bool pm_held;
+#endif
+	struct k_work_delayable read_work;
+#if MB7040_HAS_STATUS_GPIO
+	/* enum mb7040_edge_state of the current cycle */
+	atomic_t edge_state;
+	/* Status falling edge time, captured in the ISR */
+	uint64_t edge_ns;
+	struct gpio_callback gpio_cb;
+#endif
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+	/* Uptime past which a NACKed read is treated as a failure */
+	int64_t deadline_ticks;
+	/* Current retry interval while the sensor NACKs */
+	uint32_t poll_us;
+#endif
+#ifdef CONFIG_SENSOR_ASYNC_API
+	/* Read request completed by the current range cycle, if any */
+	struct rtio_iodev_sqe *pending_sqe;
+	struct mb7040_encoded_data *pending_buf;
+	/* Read requests waiting for the sensor, oldest first */
+	struct mpsc sqe_q;
+	/* Serializes taking requests off sqe_q with claiming the sensor for them */
+	struct k_spinlock sqe_lock;
+	/* Requests in sqe_q, tells range cycles whether someone is waiting behind them */
+	atomic_t sqe_queued;
+	/* Starts the next queued request once a cycle completes */
+	struct k_work sqe_work;
+#endif
+#ifdef CONFIG_MB7040_STREAM
+	struct mb7040_stream stream;
+#endif
+#ifdef CONFIG_MB7040_TRIGGER
+	struct mb7040_trigger trigger;
+#endif
+#ifdef CONFIG_MB7040_FILTER
+	struct mb7040_filter filter;
+#endif
+#ifdef CONFIG_MB7040_VELOCITY
+	struct mb7040_velocity velocity;
+#endif
+#ifdef CONFIG_MB7040_STATS
+	struct mb7040_counters counters;
+#endif
+#if defined(CONFIG_MB7040_STATS) || defined(CONFIG_MB7040_TRACING)
+	/* Time of each mark in the current cycle, 0 if not reached */
+	uint64_t marks[MB7040_MARK_COUNT];
+#endif
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	struct mb7040_sched *sched;
+	sys_snode_t sched_node;
+	/* Set when this instance wants to range in its group's next slot */
+	atomic_t sched_pending;
+	/* Set while this instance counts towards its scheduler's outstanding members */
+	atomic_t sched_fired;
+#endif
+};
+
+struct mb7040_config {
+	struct i2c_dt_spec i2c;
+#if MB7040_HAS_STATUS_GPIO
+	struct gpio_dt_spec status_gpio;
+#endif
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	uint8_t firing_group;
+#endif
+};
+
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+/* Adaptive timing replaces the fixed delay only where there is no status GPIO */
+static inline bool mb7040_use_adaptive(const struct mb7040_config *cfg)
+{
+#if MB7040_HAS_STATUS_GPIO
+	return cfg->status_gpio.port == NULL;
+#else
+	ARG_UNUSED(cfg);
+
+	return true;
+#endif
+}
+
+/* Expected ranging time: fixed sensor overhead plus the round trip time of flight of the last
+ * distance at 343 m/s
+ */
+static inline uint32_t mb7040_predict_us(const struct mb7040_data *data)
+{
+	return CONFIG_MB7040_ADAPTIVE_OVERHEAD_US + (uint32_t)data->distance_cm * 20000U / 343U;
+}
+#endif
+
+int mb7040_range_start(const struct device *dev);
+int mb7040_range_fire(const struct device *dev);
+void mb7040_range_complete(struct mb7040_data *data, int result);
+void mb7040_sample_update(struct mb7040_data *data, uint16_t distance_cm, uint64_t timestamp_ns);
+k_timeout_t mb7040_next_cycle_delay(struct mb7040_data *data, uint32_t default_us);
+
+/* Ranging is blocked while the device is suspended other than by runtime PM between cycles */
+static inline bool mb7040_is_suspended(const struct device *dev)
+{
+#ifdef CONFIG_PM_DEVICE
+	enum pm_device_state state;
+
+	if (pm_device_runtime_is_enabled(dev)) {
+		/* Each cycle resumes the device through pm_device_runtime_get() */
+		return false;
+	}
+
+	return pm_device_state_get(dev, &state) == 0 && state != PM_DEVICE_STATE_ACTIVE;
+#else
+	ARG_UNUSED(dev);
+
+	return false;
+#endif
+}
+
+#if defined(CONFIG_MB7040_STATS) || defined(CONFIG_MB7040_TRACING)
+/* Timestamp a phase boundary of the current cycle and emit its trace event */
+void mb7040_mark(struct mb7040_data *data, enum mb7040_mark mark);
+#else
+static inline void mb7040_mark(struct mb7040_data *data, enum mb7040_mark mark)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(mark);
+}
+#endif
+
+#ifdef CONFIG_MB7040_STATS
+/* Account for a finished range cycle that started at @p start_ticks */
+void mb7040_count_cycle(struct mb7040_data *data, int result, int64_t start_ticks);
+
+static inline void mb7040_count_i2c_error(struct mb7040_data *data)
+{
+	data->counters.i2c_errors++;
+}
+#else
+static inline void mb7040_count_cycle(struct mb7040_data *data, int result, int64_t start_ticks)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(result);
+	ARG_UNUSED(start_ticks);
+}
+
+static inline void mb7040_count_i2c_error(struct mb7040_data *data)
+{
+	ARG_UNUSED(data);
+}
+#endif
+
+#ifdef CONFIG_SENSOR_ASYNC_API
+void mb7040_submit_init(struct mb7040_data *data);
+void mb7040_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe);
+void mb7040_submit_complete(struct mb7040_data *data, struct rtio_iodev_sqe *iodev_sqe,
+			    struct mb7040_encoded_data *edata, int result);
+int mb7040_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder);
+#endif
+
+#ifdef CONFIG_MB7040_STREAM
+void mb7040_stream_init(struct mb7040_data *data);
+void mb7040_stream_push(struct mb7040_data *data, int result);
+
+static inline bool mb7040_is_streaming(struct mb7040_data *data)
+{
+	return atomic_get(&data->stream.enabled) != 0;
+}
+#else
+static inline bool mb7040_is_streaming(struct mb7040_data *data)
+{
+	ARG_UNUSED(data);
+
+	return false;
+}
+#endif
+
+#ifdef CONFIG_MB7040_FILTER
+uint16_t mb7040_filter_apply(struct mb7040_filter *f, uint16_t distance_cm,
+			     uint64_t timestamp_ns);
+#endif
+
+#ifdef CONFIG_MB7040_VELOCITY
+void mb7040_velocity_update(struct mb7040_velocity *vf, uint16_t distance_cm,
+			    uint64_t timestamp_ns);
+void mb7040_velocity_get(const struct mb7040_velocity *vf, struct sensor_value *val);
+#endif
+
+#ifdef CONFIG_MB7040_TRIGGER
+void mb7040_trigger_init(struct mb7040_data *data);
+void mb7040_trigger_check(struct mb7040_data *data, int result);
+int mb7040_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+		       sensor_trigger_handler_t handler);
+int mb7040_trigger_attr_set(const struct device *dev, enum sensor_attribute attr,
+			    const struct sensor_value *val);
+int mb7040_trigger_attr_get(const struct device *dev, enum sensor_attribute attr,
+			    struct sensor_value *val);
+#endif
+
+/* Whether cycles are started by the driver itself rather than by fetch calls */
+static inline bool mb7040_is_background(struct mb7040_data *data)
+{
+#ifdef CONFIG_MB7040_TRIGGER
+	if (atomic_get(&data->trigger.armed)) {
+		return true;
+	}
+#endif
+	return mb7040_is_streaming(data);
+}
+
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+int mb7040_sched_register(const struct device *dev);
+int mb7040_sched_request(const struct device *dev);
+void mb7040_sched_done(struct mb7040_data *data);
+int mb7040_sched_acquire(const struct device *dev);
+void mb7040_sched_release(const struct device *dev);
+#endif
+
+#endif /* ZEPHYR_DRIVERS_SENSOR_MB7040_MB7040_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/logging/log.h>
+#include <zephyr/rtio/rtio.h>
+
+#include "mb7040.h"
+
+LOG_MODULE_DECLARE(mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+void mb7040_submit_complete(struct mb7040_data *data, struct rtio_iodev_sqe *iodev_sqe,
+			    struct mb7040_encoded_data *edata, int result)
+{
+	if (result != 0) {
+		rtio_iodev_sqe_err(iodev_sqe, result);
+		return;
+	}
+
+	edata->timestamp_ns = data->timestamp_ns;
+	edata->distance_cm = data->distance_cm;
+	rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+/* Start a range cycle for the oldest queued read request, unless the sensor is busy */
+static void mb7040_submit_next(struct mb7040_data *data)
+{
+	uint32_t min_buf_len = sizeof(struct mb7040_encoded_data);
+	struct rtio_iodev_sqe *iodev_sqe;
+	struct mpsc_node *node;
+	k_spinlock_key_t key;
+	uint8_t *buf;
+	uint32_t buf_len;
+	int ret;
+
+	while (true) {
+		key = k_spin_lock(&data->sqe_lock);
+		if (!atomic_cas(&data->state, MB7040_STATE_IDLE, MB7040_STATE_RANGING)) {
+			/* The cycle in progress kicks sqe_work once it completes */
+			k_spin_unlock(&data->sqe_lock, key);
+			return;
+		}
+
+		node = mpsc_pop(&data->sqe_q);
+		if (node == NULL) {
+			atomic_set(&data->state, MB7040_STATE_IDLE);
+			k_spin_unlock(&data->sqe_lock, key);
+			return;
+		}
+		atomic_dec(&data->sqe_queued);
+		k_spin_unlock(&data->sqe_lock, key);
+
+		iodev_sqe = CONTAINER_OF(node, struct rtio_iodev_sqe, q);
+		ret = rtio_sqe_rx_buf(iodev_sqe, min_buf_len, min_buf_len, &buf, &buf_len);
+		if (ret == 0) {
+			break;
+		}
+
+		LOG_ERR("Failed to get a read buffer of size %u bytes", min_buf_len);
+		atomic_set(&data->state, MB7040_STATE_IDLE);
+		rtio_iodev_sqe_err(iodev_sqe, ret);
+	}
+
+	/* Filled in and completed from the read work item */
+	data->pending_sqe = iodev_sqe;
+	data->pending_buf = (struct mb7040_encoded_data *)buf;
+
+	ret = mb7040_range_start(data->dev);
+	if (ret != 0) {
+		mb7040_range_complete(data, ret);
+	}
+}
+
+static void mb7040_sqe_work_handler(struct k_work *work)
+{
+	struct mb7040_data *data = CONTAINER_OF(work, struct mb7040_data, sqe_work);
+
+	mb7040_submit_next(data);
+}
+
+void mb7040_submit_init(struct mb7040_data *data)
+{
+	mpsc_init(&data->sqe_q);
+	k_work_init(&data->sqe_work, mb7040_sqe_work_handler);
+}
+
+void mb7040_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct sensor_read_config *cfg = iodev_sqe->sqe.iodev->data;
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	if (cfg->is_streaming) {
+		LOG_ERR("Streaming not supported");
+		rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+		return;
+	}
+
+	for (size_t i = 0; i < cfg->count; i++) {
+		if (cfg->channels[i].chan_type != SENSOR_CHAN_DISTANCE &&
+		    cfg->channels[i].chan_type != SENSOR_CHAN_ALL) {
+			LOG_ERR("Sensor only supports distance");
+			rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+			return;
+		}
+	}
+
+	/* Each request gets a range cycle of its own, in submission order */
+	atomic_inc(&data->sqe_queued);
+	mpsc_push(&data->sqe_q, &iodev_sqe->q);
+	mb7040_submit_next(data);
+}
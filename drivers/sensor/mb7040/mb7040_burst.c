@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/logging/log.h>
+
+#include "mb7040.h"
+
+LOG_MODULE_DECLARE(mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+/* Longest time from the range command until the status pin goes active */
+#define MB7040_STATUS_RISE_MS 5
+
+/* Block until the sensor finished the range cycle started by the last RANGE_CMD. @p ready_ns is
+ * set to when the status pin dropped, or left alone without a status GPIO.
+ */
+static int mb7040_burst_wait(const struct device *dev, uint64_t *ready_ns)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+#if MB7040_HAS_STATUS_GPIO
+	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
+
+	if (cfg->status_gpio.port != NULL) {
+		int64_t deadline = k_uptime_get() + MB7040_STATUS_RISE_MS;
+		int ret;
+
+		/*
+		 * Right after the range command the pin may still be inactive, seeing it low now
+		 * doesn't mean ranging is over. Ranging takes far longer than the polling interval,
+		 * the active phase is only missed if this thread is held off for a whole cycle.
+		 */
+		while ((ret = gpio_pin_get_dt(&cfg->status_gpio)) == 0) {
+			if (k_uptime_get() >= deadline) {
+				LOG_ERR("Status GPIO never went active");
+				return -ETIMEDOUT;
+			}
+			k_msleep(1);
+		}
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Status pin is active while ranging */
+		deadline = k_uptime_get() + data->delay_ms;
+		while ((ret = gpio_pin_get_dt(&cfg->status_gpio)) > 0) {
+			if (k_uptime_get() >= deadline) {
+				LOG_ERR("Status GPIO timed out");
+				return -ETIMEDOUT;
+			}
+			k_msleep(1);
+		}
+		if (ret < 0) {
+			return ret;
+		}
+
+		*ready_ns = mb7040_timestamp_ns();
+		mb7040_mark(data, MB7040_MARK_READY);
+		k_msleep(MB7040_SETTLE_MS);
+		return 0;
+	}
+#endif
+
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+	/* The transfer itself polls for ACK, only sleep until just before the prediction */
+	uint32_t predict_us = mb7040_predict_us(data);
+
+	if (predict_us > CONFIG_MB7040_ADAPTIVE_POLL_US) {
+		k_usleep(predict_us - CONFIG_MB7040_ADAPTIVE_POLL_US);
+	}
+#else
+	k_msleep(data->delay_ms + MB7040_SETTLE_MS);
+#endif
+
+	return 0;
+}
+
+/* Read the finished sample and, if @p next is set, start the next range cycle in the same
+ * transaction
+ */
+static int mb7040_burst_read(const struct device *dev, uint8_t read_data[2], bool next)
+{
+	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
+	uint8_t cmd = RANGE_CMD;
+	struct i2c_msg msgs[2] = {
+		{
+			.buf = read_data,
+			.len = 2,
+			.flags = I2C_MSG_READ,
+		},
+		{
+			.buf = &cmd,
+			.len = 1,
+			.flags = I2C_MSG_WRITE | I2C_MSG_RESTART | I2C_MSG_STOP,
+		},
+	};
+	int ret;
+
+	if (!next) {
+		msgs[0].flags |= I2C_MSG_STOP;
+	}
+
+#ifdef CONFIG_MB7040_ADAPTIVE_TIMING
+	if (mb7040_use_adaptive(cfg)) {
+		struct mb7040_data *data = (struct mb7040_data *)dev->data;
+		int64_t deadline = k_uptime_get() + data->delay_ms + MB7040_SETTLE_MS;
+		uint32_t poll_us = CONFIG_MB7040_ADAPTIVE_POLL_US;
+
+		/* Sensor NACKs the read while still ranging, nothing reached it yet */
+		while ((ret = i2c_transfer_dt(&cfg->i2c, msgs, next ? 2 : 1)) == -EIO &&
+		       k_uptime_get() < deadline) {
+			k_usleep(poll_us);
+			poll_us = MIN(poll_us * 2U, CONFIG_MB7040_ADAPTIVE_POLL_MAX_US);
+		}
+		return ret;
+	}
+#endif
+
+	return i2c_transfer_dt(&cfg->i2c, msgs, next ? 2 : 1);
+}
+
+int mb7040_fetch_burst(const struct device *dev, struct mb7040_sample *buf, size_t n)
+{
+	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	uint8_t cmd = RANGE_CMD;
+	uint8_t read_data[2];
+	int64_t start_ticks;
+	size_t count = 0;
+	int ret;
+
+	if (n == 0) {
+		return 0;
+	}
+
+	if (mb7040_is_background(data) || mb7040_is_suspended(dev) ||
+	    !atomic_cas(&data->state, MB7040_STATE_IDLE, MB7040_STATE_RANGING)) {
+		return -EBUSY;
+	}
+
+	ret = pm_device_runtime_get(dev);
+	if (ret < 0) {
+		atomic_set(&data->state, MB7040_STATE_IDLE);
+		return ret;
+	}
+
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	/* Held for the whole burst, no other firing group ranges until it is done */
+	ret = mb7040_sched_acquire(dev);
+	if (ret != 0) {
+		pm_device_runtime_put(dev);
+		atomic_set(&data->state, MB7040_STATE_IDLE);
+		return ret;
+	}
+#endif
+
+	start_ticks = k_uptime_ticks();
+	mb7040_mark(data, MB7040_MARK_WRITE);
+	ret = i2c_write_dt(&cfg->i2c, &cmd, 1);
+	if (ret != 0) {
+		LOG_ERR("I2C write failed with error %d", ret);
+		mb7040_count_i2c_error(data);
+		mb7040_count_cycle(data, ret, start_ticks);
+	} else {
+		mb7040_mark(data, MB7040_MARK_WRITTEN);
+	}
+
+	while (ret == 0 && count < n) {
+		uint64_t ready_ns = 0;
+
+		ret = mb7040_burst_wait(dev, &ready_ns);
+		if (ret != 0) {
+			mb7040_count_cycle(data, ret, start_ticks);
+			break;
+		}
+
+		mb7040_mark(data, MB7040_MARK_READ);
+		ret = mb7040_burst_read(dev, read_data, count + 1 < n);
+		if (ret != 0) {
+			LOG_ERR("I2C transfer failed with error %d", ret);
+			mb7040_count_i2c_error(data);
+			mb7040_count_cycle(data, ret, start_ticks);
+			break;
+		}
+		mb7040_mark(data, MB7040_MARK_DONE);
+		mb7040_count_cycle(data, 0, start_ticks);
+		if (count + 1 < n) {
+			/* The next range command went out in the same transaction */
+			start_ticks = k_uptime_ticks();
+			mb7040_mark(data, MB7040_MARK_WRITTEN);
+		}
+
+		/* Convert MSB/LSB to distance in cm */
+		mb7040_sample_update(data, (read_data[0] << 8) | read_data[1],
+				     ready_ns != 0 ? ready_ns : mb7040_timestamp_ns());
+
+		buf[count].timestamp_ns = data->timestamp_ns;
+		buf[count].distance_cm = data->distance_cm;
+		buf[count].status = 0;
+		count++;
+	}
+
+	/* channel_get reports the last sample of the burst */
+	data->result = count > 0 ? 0 : ret;
+	atomic_set(&data->state, MB7040_STATE_IDLE);
+#ifdef CONFIG_MB7040_BUS_SCHEDULER
+	mb7040_sched_release(dev);
+#endif
+	pm_device_runtime_put(dev);
+
+	return count > 0 ? (int)count : ret;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/drivers/sensor.h>
+
+#include "mb7040.h"
+
+/* Distance is reported in meters, the sensor tops out well below 2^3 m */
+#define MB7040_DISTANCE_SHIFT 3
+
+static int mb7040_decoder_get_frame_count(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+					  uint16_t *frame_count)
+{
+	ARG_UNUSED(buffer);
+
+	if (chan_spec.chan_type != SENSOR_CHAN_DISTANCE || chan_spec.chan_idx != 0) {
+		return -ENOTSUP;
+	}
+
+	*frame_count = 1;
+	return 0;
+}
+
+static int mb7040_decoder_get_size_info(struct sensor_chan_spec chan_spec, size_t *base_size,
+					size_t *frame_size)
+{
+	if (chan_spec.chan_type != SENSOR_CHAN_DISTANCE) {
+		return -ENOTSUP;
+	}
+
+	*base_size = sizeof(struct sensor_q31_data);
+	*frame_size = sizeof(struct sensor_q31_sample_data);
+	return 0;
+}
+
+static int mb7040_decoder_decode(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+				 uint32_t *fit, uint16_t max_count, void *data_out)
+{
+	const struct mb7040_encoded_data *edata = (const struct mb7040_encoded_data *)buffer;
+	struct sensor_q31_data *out = data_out;
+	int64_t value;
+
+	if (*fit != 0 || max_count == 0) {
+		return 0;
+	}
+
+	if (chan_spec.chan_type != SENSOR_CHAN_DISTANCE || chan_spec.chan_idx != 0) {
+		return -ENOTSUP;
+	}
+
+	/* cm -> meters in Q31 with MB7040_DISTANCE_SHIFT integer bits */
+	value = ((int64_t)edata->distance_cm << (31 - MB7040_DISTANCE_SHIFT)) / 100;
+
+	out->header.base_timestamp_ns = edata->timestamp_ns;
+	out->header.reading_count = 1;
+	out->shift = MB7040_DISTANCE_SHIFT;
+	out->readings[0].timestamp_delta = 0;
+	out->readings[0].value = (q31_t)CLAMP(value, INT32_MIN, INT32_MAX);
+
+	*fit = 1;
+	return 1;
+}
+
+static bool mb7040_decoder_has_trigger(const uint8_t *buffer, enum sensor_trigger_type trigger)
+{
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(trigger);
+
+	return false;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+	.get_frame_count = mb7040_decoder_get_frame_count,
+	.get_size_info = mb7040_decoder_get_size_info,
+	.decode = mb7040_decoder_decode,
+	.has_trigger = mb7040_decoder_has_trigger,
+};
+
+int mb7040_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder)
+{
+	ARG_UNUSED(dev);
+
+	*decoder = &SENSOR_DECODER_NAME();
+	return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <string.h>
+
+#include "mb7040.h"
+
+#ifdef CONFIG_MB7040_FILTER_MEDIAN
+BUILD_ASSERT((CONFIG_MB7040_FILTER_MEDIAN_WINDOW & 1) == 1,
+	     "CONFIG_MB7040_FILTER_MEDIAN_WINDOW must be odd");
+
+/* First index in the sorted window whose value is not less than @p value */
+static size_t mb7040_median_lower_bound(const uint16_t *sorted, size_t count, uint16_t value)
+{
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (sorted[mid] < value) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/*
+ * The window is kept twice: in arrival order to know which sample leaves, and sorted to read
+ * the median. Each sample costs two binary searches and two short memmoves, never a sort.
+ */
+static uint16_t mb7040_median_apply(struct mb7040_filter *f, uint16_t distance_cm)
+{
+	size_t pos;
+
+	if (f->median_count == CONFIG_MB7040_FILTER_MEDIAN_WINDOW) {
+		uint16_t oldest = f->median_fifo[f->median_next];
+
+		pos = mb7040_median_lower_bound(f->median_sorted, f->median_count, oldest);
+		memmove(&f->median_sorted[pos], &f->median_sorted[pos + 1],
+			(f->median_count - pos - 1) * sizeof(f->median_sorted[0]));
+		f->median_count--;
+	}
+
+	pos = mb7040_median_lower_bound(f->median_sorted, f->median_count, distance_cm);
+	memmove(&f->median_sorted[pos + 1], &f->median_sorted[pos],
+		(f->median_count - pos) * sizeof(f->median_sorted[0]));
+	f->median_sorted[pos] = distance_cm;
+	f->median_count++;
+
+	f->median_fifo[f->median_next] = distance_cm;
+	f->median_next = (f->median_next + 1) % CONFIG_MB7040_FILTER_MEDIAN_WINDOW;
+
+	return f->median_sorted[f->median_count / 2];
+}
+#endif
+
+#ifdef CONFIG_MB7040_FILTER_SLEW
+/* Limit the change from the last output to what a real target could move since then */
+static uint16_t mb7040_slew_apply(struct mb7040_filter *f, uint16_t distance_cm,
+				  uint64_t timestamp_ns)
+{
+	uint64_t dt_us = (timestamp_ns - f->last_ns) / NSEC_PER_USEC;
+	uint64_t max_step = (uint64_t)CONFIG_MB7040_FILTER_SLEW_MAX_CM_PER_S * dt_us / USEC_PER_SEC;
+
+	if (distance_cm > f->last_cm && distance_cm - f->last_cm > max_step) {
+		return f->last_cm + max_step;
+	}
+	if (distance_cm < f->last_cm && f->last_cm - distance_cm > max_step) {
+		return f->last_cm - max_step;
+	}
+
+	return distance_cm;
+}
+#endif
+
+#ifdef CONFIG_MB7040_FILTER_EMA
+/* Exponential moving average, state in 1/256 cm so small steps are not lost to rounding */
+static uint16_t mb7040_ema_apply(struct mb7040_filter *f, uint16_t distance_cm)
+{
+	int32_t x = (int32_t)distance_cm << 8;
+
+	f->ema_q8 += (x - f->ema_q8) * CONFIG_MB7040_FILTER_EMA_ALPHA / 1000;
+
+	return (uint16_t)((f->ema_q8 + 128) >> 8);
+}
+#endif
+
+uint16_t mb7040_filter_apply(struct mb7040_filter *f, uint16_t distance_cm,
+			     uint64_t timestamp_ns)
+{
+	uint16_t out = distance_cm;
+
+#ifdef CONFIG_MB7040_FILTER_MEDIAN
+	/* Median first, so single spikes never reach the stages below */
+	out = mb7040_median_apply(f, out);
+#endif
+
+	if (!f->valid || timestamp_ns <= f->last_ns) {
+		/* First sample, nothing to limit or average against yet */
+#ifdef CONFIG_MB7040_FILTER_EMA
+		f->ema_q8 = (int32_t)out << 8;
+#endif
+		f->valid = true;
+	} else {
+#ifdef CONFIG_MB7040_FILTER_SLEW
+		out = mb7040_slew_apply(f, out, timestamp_ns);
+#endif
+	}
+
+	f->last_cm = out;
+	f->last_ns = timestamp_ns;
+
+#ifdef CONFIG_MB7040_FILTER_EMA
+	out = mb7040_ema_apply(f, out);
+#endif
+
+	return out;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/logging/log.h>
+
+#include "mb7040.h"
+
+LOG_MODULE_DECLARE(mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+/* Worst case every instance sits on its own bus */
+static struct mb7040_sched mb7040_scheds[DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT)];
+
+/* Next group after @p after that has a pending member, wrapping around, or -1 */
+static int mb7040_sched_next_group(struct mb7040_sched *sched, int after)
+{
+	struct mb7040_data *member;
+	int next = -1;
+	int lowest = -1;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&sched->members, member, sched_node) {
+		const struct mb7040_config *cfg = member->dev->config;
+		int group = cfg->firing_group;
+
+		if (!atomic_get(&member->sched_pending)) {
+			continue;
+		}
+		if (lowest < 0 || group < lowest) {
+			lowest = group;
+		}
+		if (group > after && (next < 0 || group < next)) {
+			next = group;
+		}
+	}
+
+	return next >= 0 ? next : lowest;
+}
+
+static void mb7040_sched_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct mb7040_sched *sched = CONTAINER_OF(dwork, struct mb7040_sched, work);
+	struct mb7040_data *member;
+	int group;
+	int ret;
+
+	/* Hold the bus while firing so a burst can't claim it between members */
+	if (!atomic_cas(&sched->outstanding, 0, 1)) {
+		/* Current group or a burst still ranging, whoever finishes last kicks us again */
+		return;
+	}
+
+	group = mb7040_sched_next_group(sched, sched->group);
+	if (group < 0) {
+		atomic_dec(&sched->outstanding);
+		return;
+	}
+	sched->group = group;
+
+	/* Fire every pending member of the group back to back so they range together */
+	SYS_SLIST_FOR_EACH_CONTAINER(&sched->members, member, sched_node) {
+		const struct mb7040_config *cfg = member->dev->config;
+
+		if (cfg->firing_group != group || !atomic_cas(&member->sched_pending, 1, 0)) {
+			continue;
+		}
+
+		atomic_set(&member->sched_fired, 1);
+		atomic_inc(&sched->outstanding);
+		ret = mb7040_range_fire(member->dev);
+		if (ret != 0) {
+			mb7040_range_complete(member, ret);
+		}
+	}
+
+	/* The fired members keep the bus, unless every one of them already failed */
+	if (atomic_dec(&sched->outstanding) == 1) {
+		k_work_reschedule(&sched->work, K_NO_WAIT);
+	}
+}
+
+int mb7040_sched_request(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	atomic_set(&data->sched_pending, 1);
+	k_work_reschedule(&data->sched->work, K_NO_WAIT);
+
+	return 0;
+}
+
+void mb7040_sched_done(struct mb7040_data *data)
+{
+	struct mb7040_sched *sched = data->sched;
+
+	/* A cycle that failed before its slot never fired, drop the request too */
+	atomic_set(&data->sched_pending, 0);
+	if (!atomic_cas(&data->sched_fired, 1, 0)) {
+		return;
+	}
+
+	if (atomic_dec(&sched->outstanding) == 1) {
+		/* Last member of the group is read, the bus is quiet again */
+		k_work_reschedule(&sched->work, K_NO_WAIT);
+	}
+}
+
+int mb7040_sched_acquire(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	/* Only between groups, a burst must not range alongside another group */
+	return atomic_cas(&data->sched->outstanding, 0, 1) ? 0 : -EBUSY;
+}
+
+void mb7040_sched_release(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_sched *sched = data->sched;
+
+	atomic_dec(&sched->outstanding);
+	/* Requests that came in during the burst waited for the bus */
+	k_work_reschedule(&sched->work, K_NO_WAIT);
+}
+
+int mb7040_sched_register(const struct device *dev)
+{
+	const struct mb7040_config *cfg = (struct mb7040_config *)dev->config;
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_sched *sched = NULL;
+
+	/* Runs from device init, instances are registered one at a time */
+	ARRAY_FOR_EACH_PTR(mb7040_scheds, it) {
+		if (it->bus == cfg->i2c.bus || it->bus == NULL) {
+			sched = it;
+			break;
+		}
+	}
+
+	if (sched == NULL) {
+		return -ENOMEM;
+	}
+
+	if (sched->bus == NULL) {
+		sched->bus = cfg->i2c.bus;
+		sched->group = -1;
+		sys_slist_init(&sched->members);
+		k_work_init_delayable(&sched->work, mb7040_sched_work_handler);
+	}
+
+	data->sched = sched;
+	sys_slist_append(&sched->members, &data->sched_node);
+	LOG_DBG("%s: scheduled on %s in firing group %u", dev->name, cfg->i2c.bus->name,
+		cfg->firing_group);
+
+	return 0;
+}
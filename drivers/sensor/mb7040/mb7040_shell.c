@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "mb7040.h"
+
+#define MB7040_SHELL_DEV(inst) DEVICE_DT_INST_GET(inst),
+
+static const struct device *const mb7040_devs[] = {
+	DT_INST_FOREACH_STATUS_OKAY(MB7040_SHELL_DEV)
+};
+
+static const char *const mb7040_phase_names[MB7040_PHASE_COUNT] = {
+	[MB7040_PHASE_WRITE] = "write",
+	[MB7040_PHASE_WAIT] = "wait",
+	[MB7040_PHASE_SETTLE] = "settle",
+	[MB7040_PHASE_READ] = "read",
+};
+
+static const struct device *mb7040_shell_dev(const struct shell *sh, const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(mb7040_devs); i++) {
+		if (strcmp(mb7040_devs[i]->name, name) != 0) {
+			continue;
+		}
+		if (!device_is_ready(mb7040_devs[i])) {
+			shell_error(sh, "%s: device not ready", name);
+			return NULL;
+		}
+		return mb7040_devs[i];
+	}
+
+	shell_error(sh, "%s: not an MB7040 instance", name);
+	return NULL;
+}
+
+/* Decimal number with up to six fractional digits, e.g. "12.5" */
+static int mb7040_shell_parse(const char *str, struct sensor_value *val)
+{
+	int32_t scale = 100000;
+	char *end;
+	long whole;
+
+	whole = strtol(str, &end, 10);
+	if (end == str || whole < 0 || whole > INT32_MAX) {
+		return -EINVAL;
+	}
+
+	val->val1 = whole;
+	val->val2 = 0;
+	if (*end == '.') {
+		for (end++; *end >= '0' && *end <= '9'; end++) {
+			val->val2 += (*end - '0') * scale;
+			scale /= 10;
+		}
+	}
+
+	return *end == '\0' ? 0 : -EINVAL;
+}
+
+static int cmd_list(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	for (size_t i = 0; i < ARRAY_SIZE(mb7040_devs); i++) {
+		const struct device *dev = mb7040_devs[i];
+		const struct mb7040_config *cfg = dev->config;
+		bool status_gpio = false;
+
+#if MB7040_HAS_STATUS_GPIO
+		status_gpio = cfg->status_gpio.port != NULL;
+#endif
+		shell_print(sh, "%-16s %s addr 0x%02x%s%s%s", dev->name, cfg->i2c.bus->name,
+			    cfg->i2c.addr, status_gpio ? " status-gpio" : "",
+			    device_is_ready(dev) ? "" : " not-ready",
+			    mb7040_is_streaming(dev->data) ? " streaming" : "");
+	}
+
+	return 0;
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = mb7040_shell_dev(sh, argv[1]);
+	struct mb7040_stats stats;
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+
+	if (argc > 2) {
+		if (strcmp(argv[2], "reset") != 0) {
+			shell_error(sh, "Unknown argument: %s", argv[2]);
+			return -EINVAL;
+		}
+		mb7040_stats_reset(dev);
+		return 0;
+	}
+
+	mb7040_stats_get(dev, &stats);
+	shell_print(sh, "fetches:    %u", stats.fetches);
+	shell_print(sh, "errors:     %u", stats.errors);
+	shell_print(sh, "timeouts:   %u", stats.timeouts);
+	shell_print(sh, "i2c errors: %u", stats.i2c_errors);
+	shell_print(sh, "latency:    avg %u us, max %u us", stats.latency_avg_us,
+		    stats.latency_max_us);
+	shell_print(sh, "phase       min/avg/max us");
+	for (int i = 0; i < MB7040_PHASE_COUNT; i++) {
+		shell_print(sh, "  %-9s %u/%u/%u", mb7040_phase_names[i], stats.phase[i].min_us,
+			    stats.phase[i].avg_us, stats.phase[i].max_us);
+	}
+
+	return 0;
+}
+
+static int cmd_rate(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = mb7040_shell_dev(sh, argv[1]);
+	struct sensor_value rate;
+	int ret;
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+
+	if (argc < 3) {
+		sensor_attr_get(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY, &rate);
+		if (rate.val1 == 0 && rate.val2 == 0) {
+			shell_print(sh, "default");
+		} else {
+			shell_print(sh, "%d.%06d Hz", rate.val1, rate.val2);
+		}
+		return 0;
+	}
+
+	if (mb7040_shell_parse(argv[2], &rate) != 0) {
+		shell_error(sh, "Invalid rate: %s", argv[2]);
+		return -EINVAL;
+	}
+
+	ret = sensor_attr_set(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY, &rate);
+	if (ret != 0) {
+		shell_error(sh, "%s: failed to set rate: %d", dev->name, ret);
+	}
+
+	return ret;
+}
+
+static int cmd_delay(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = mb7040_shell_dev(sh, argv[1]);
+	struct sensor_value delay;
+	unsigned long ms;
+	int err = 0;
+	int ret;
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+
+	if (argc < 3) {
+		sensor_attr_get(dev, SENSOR_CHAN_DISTANCE,
+				(enum sensor_attribute)SENSOR_ATTR_MB7040_READ_DELAY, &delay);
+		shell_print(sh, "%d ms", delay.val1 * 1000 + delay.val2 / 1000);
+		return 0;
+	}
+
+	ms = shell_strtoul(argv[2], 10, &err);
+	if (err != 0) {
+		shell_error(sh, "Invalid delay: %s", argv[2]);
+		return -EINVAL;
+	}
+
+	delay.val1 = ms / 1000;
+	delay.val2 = (ms % 1000) * 1000;
+	ret = sensor_attr_set(dev, SENSOR_CHAN_DISTANCE,
+			      (enum sensor_attribute)SENSOR_ATTR_MB7040_READ_DELAY, &delay);
+	if (ret != 0) {
+		shell_error(sh, "%s: failed to set delay: %d", dev->name, ret);
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_MB7040_STREAM
+/* Longest gap between streamed samples before the stream is considered stalled */
+static uint32_t mb7040_shell_stall_ms(struct mb7040_data *data)
+{
+	uint32_t cycle_ms = k_us_to_ms_ceil32(data->period_us) + data->delay_ms + MB7040_SETTLE_MS;
+
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+	cycle_ms += CONFIG_MB7040_DUTY_CYCLE_MAX_MS;
+#endif
+
+	return 3 * cycle_ms;
+}
+
+static int cmd_stream(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = mb7040_shell_dev(sh, argv[1]);
+	struct sensor_value old_rate, rate;
+	struct mb7040_sample batch[8];
+	unsigned long count = 10;
+	unsigned long printed = 0;
+	int64_t last_ms;
+	int err = 0;
+	int ret;
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+
+	if (mb7040_shell_parse(argv[2], &rate) != 0) {
+		shell_error(sh, "Invalid rate: %s", argv[2]);
+		return -EINVAL;
+	}
+
+	if (argc > 3) {
+		count = shell_strtoul(argv[3], 10, &err);
+		if (err != 0 || count == 0) {
+			shell_error(sh, "Invalid count: %s", argv[3]);
+			return -EINVAL;
+		}
+	}
+
+	sensor_attr_get(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY, &old_rate);
+	ret = sensor_attr_set(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY, &rate);
+	if (ret != 0) {
+		shell_error(sh, "%s: failed to set rate: %d", dev->name, ret);
+		return ret;
+	}
+
+	ret = mb7040_stream_start(dev);
+	if (ret != 0) {
+		/* Most likely the application is streaming and owns the ring */
+		shell_error(sh, "%s: failed to start streaming: %d", dev->name, ret);
+		sensor_attr_set(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY,
+				&old_rate);
+		return ret;
+	}
+
+	last_ms = k_uptime_get();
+	while (printed < count) {
+		size_t n = mb7040_stream_read(dev, batch, MIN(ARRAY_SIZE(batch), count - printed));
+
+		if (n == 0) {
+			if (k_uptime_get() - last_ms > mb7040_shell_stall_ms(dev->data)) {
+				shell_error(sh, "%s: no samples", dev->name);
+				ret = -ETIMEDOUT;
+				break;
+			}
+			k_msleep(10);
+			continue;
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			uint64_t ts = batch[i].timestamp_ns;
+
+			shell_print(sh, "%llu.%06u s %u cm%s%s",
+				    (unsigned long long)(ts / NSEC_PER_SEC),
+				    (uint32_t)(ts % NSEC_PER_SEC / NSEC_PER_USEC),
+				    batch[i].distance_cm,
+				    (batch[i].status & MB7040_SAMPLE_ERROR) ? " error" : "",
+				    (batch[i].status & MB7040_SAMPLE_OVERRUN) ? " overrun" : "");
+		}
+		printed += n;
+		last_ms = k_uptime_get();
+	}
+
+	mb7040_stream_stop(dev);
+	sensor_attr_set(dev, SENSOR_CHAN_DISTANCE, SENSOR_ATTR_SAMPLING_FREQUENCY, &old_rate);
+
+	return ret;
+}
+#endif
+
+#ifdef CONFIG_MB7040_BURST
+/* Burst dump record: u64 timestamp_ns, u16 distance_cm, u16 status, little endian */
+#define MB7040_SHELL_RECORD_LEN 12
+
+static struct mb7040_sample mb7040_shell_burst[CONFIG_MB7040_SHELL_BURST_MAX];
+static uint8_t mb7040_shell_records[CONFIG_MB7040_SHELL_BURST_MAX * MB7040_SHELL_RECORD_LEN];
+
+static int cmd_burst(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct device *dev = mb7040_shell_dev(sh, argv[1]);
+	unsigned long n;
+	int err = 0;
+	int ret;
+
+	ARG_UNUSED(argc);
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+
+	n = shell_strtoul(argv[2], 10, &err);
+	if (err != 0 || n == 0 || n > CONFIG_MB7040_SHELL_BURST_MAX) {
+		shell_error(sh, "Burst size must be 1 to %d", CONFIG_MB7040_SHELL_BURST_MAX);
+		return -EINVAL;
+	}
+
+	ret = mb7040_fetch_burst(dev, mb7040_shell_burst, n);
+	if (ret < 0) {
+		shell_error(sh, "%s: burst failed: %d", dev->name, ret);
+		return ret;
+	}
+
+	/* Fixed layout independent of the target's struct padding and byte order */
+	for (int i = 0; i < ret; i++) {
+		uint8_t *rec = &mb7040_shell_records[i * MB7040_SHELL_RECORD_LEN];
+
+		sys_put_le64(mb7040_shell_burst[i].timestamp_ns, rec);
+		sys_put_le16(mb7040_shell_burst[i].distance_cm, rec + 8);
+		sys_put_le16(mb7040_shell_burst[i].status, rec + 10);
+	}
+
+	shell_print(sh, "%d samples of %d bytes: u64 timestamp_ns, u16 distance_cm, "
+		    "u16 status (LE)", ret, MB7040_SHELL_RECORD_LEN);
+	shell_hexdump(sh, mb7040_shell_records, ret * MB7040_SHELL_RECORD_LEN);
+
+	return 0;
+}
+#endif
+
+static void mb7040_dsub_dev(size_t idx, struct shell_static_entry *entry)
+{
+	entry->syntax = idx < ARRAY_SIZE(mb7040_devs) ? mb7040_devs[idx]->name : NULL;
+	entry->handler = NULL;
+	entry->help = NULL;
+	entry->subcmd = NULL;
+}
+
+SHELL_DYNAMIC_CMD_CREATE(dsub_mb7040_dev, mb7040_dsub_dev);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	sub_mb7040,
+	SHELL_CMD_ARG(list, NULL, "List instances and their bus addresses", cmd_list, 1, 0),
+	SHELL_CMD_ARG(stats, &dsub_mb7040_dev,
+		      "<device> [reset]\nShow or zero fetch, error and latency counters",
+		      cmd_stats, 2, 1),
+	SHELL_CMD_ARG(rate, &dsub_mb7040_dev,
+		      "<device> [Hz]\nShow or set the background ranging rate, 0 for the default",
+		      cmd_rate, 2, 1),
+	SHELL_CMD_ARG(delay, &dsub_mb7040_dev,
+		      "<device> [ms]\nShow or set the read delay, or status GPIO timeout",
+		      cmd_delay, 2, 1),
+	/* Not SHELL_COND_CMD_ARG, that still names the handler when the option is off */
+	IF_ENABLED(CONFIG_MB7040_STREAM,
+		   (SHELL_CMD_ARG(stream, &dsub_mb7040_dev,
+				  "<device> <Hz> [count]\nStream count samples (default 10) "
+				  "at a rate, 0 Hz for back-to-back. Fails while the "
+				  "application streams",
+				  cmd_stream, 3, 1),))
+	IF_ENABLED(CONFIG_MB7040_BURST,
+		   (SHELL_CMD_ARG(burst, &dsub_mb7040_dev,
+				  "<device> <count>\nTake a burst and hexdump it as binary records",
+				  cmd_burst, 3, 0),))
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(mb7040, &sub_mb7040, "MB7040 ultrasonic sensor commands", NULL);
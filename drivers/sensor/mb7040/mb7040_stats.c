@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <string.h>
+
+#ifdef CONFIG_MB7040_TRACING
+#include <zephyr/tracing/tracing.h>
+#endif
+
+#include "mb7040.h"
+
+#ifdef CONFIG_MB7040_TRACING
+/* Event names as they show up on the trace timeline */
+static const char *const mb7040_mark_names[MB7040_MARK_COUNT] = {
+	[MB7040_MARK_WRITE] = "mb7040_write",
+	[MB7040_MARK_WRITTEN] = "mb7040_written",
+	[MB7040_MARK_READY] = "mb7040_ready",
+	[MB7040_MARK_READ] = "mb7040_read",
+	[MB7040_MARK_DONE] = "mb7040_done",
+};
+#endif
+
+void mb7040_mark(struct mb7040_data *data, enum mb7040_mark mark)
+{
+	if (mark == MB7040_MARK_WRITE) {
+		/* New cycle, forget where the last one got to */
+		memset(data->marks, 0, sizeof(data->marks));
+	}
+	data->marks[mark] = mb7040_timestamp_ns();
+
+#ifdef CONFIG_MB7040_TRACING
+	const struct mb7040_config *cfg = (struct mb7040_config *)data->dev->config;
+
+	/* The address tells instances apart on the timeline */
+	sys_trace_named_event(mb7040_mark_names[mark], cfg->i2c.addr, 0);
+#endif
+}
+
+#ifdef CONFIG_MB7040_STATS
+static void mb7040_count_phase(struct mb7040_counters *c, enum mb7040_phase phase,
+			       uint64_t start_ns, uint64_t end_ns)
+{
+	struct mb7040_phase_counter *p = &c->phase[phase];
+	uint32_t ns;
+
+	if (start_ns == 0 || end_ns < start_ns) {
+		/* Not part of this cycle */
+		return;
+	}
+
+	ns = MIN(end_ns - start_ns, UINT32_MAX);
+	p->min_ns = p->count == 0 ? ns : MIN(p->min_ns, ns);
+	p->max_ns = MAX(p->max_ns, ns);
+	p->sum_ns += ns;
+	p->count++;
+}
+
+/* Split a successful cycle into phases along its marks */
+static void mb7040_count_phases(struct mb7040_data *data)
+{
+	struct mb7040_counters *c = &data->counters;
+	const uint64_t *m = data->marks;
+	/* Without a status GPIO ranging lasts until the read that succeeded */
+	uint64_t ready = m[MB7040_MARK_READY] != 0 ? m[MB7040_MARK_READY] : m[MB7040_MARK_READ];
+
+	mb7040_count_phase(c, MB7040_PHASE_WRITE, m[MB7040_MARK_WRITE], m[MB7040_MARK_WRITTEN]);
+	mb7040_count_phase(c, MB7040_PHASE_WAIT, m[MB7040_MARK_WRITTEN], ready);
+	if (m[MB7040_MARK_READY] != 0) {
+		mb7040_count_phase(c, MB7040_PHASE_SETTLE, m[MB7040_MARK_READY],
+				   m[MB7040_MARK_READ]);
+	}
+	mb7040_count_phase(c, MB7040_PHASE_READ, m[MB7040_MARK_READ], m[MB7040_MARK_DONE]);
+
+	/* Chained burst cycles start without a write mark, don't let them see these */
+	memset(data->marks, 0, sizeof(data->marks));
+}
+
+void mb7040_count_cycle(struct mb7040_data *data, int result, int64_t start_ticks)
+{
+	struct mb7040_counters *c = &data->counters;
+	uint32_t latency_us;
+
+	c->fetches++;
+	if (result != 0) {
+		c->errors++;
+		if (result == -ETIMEDOUT) {
+			c->timeouts++;
+		}
+		return;
+	}
+
+	latency_us = k_ticks_to_us_ceil32(k_uptime_ticks() - start_ticks);
+	c->samples++;
+	c->latency_sum_us += latency_us;
+	c->latency_max_us = MAX(c->latency_max_us, latency_us);
+
+	mb7040_count_phases(data);
+}
+
+int mb7040_stats_get(const struct device *dev, struct mb7040_stats *stats)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	const struct mb7040_counters *c = &data->counters;
+
+	stats->fetches = c->fetches;
+	stats->errors = c->errors;
+	stats->timeouts = c->timeouts;
+	stats->i2c_errors = c->i2c_errors;
+	stats->latency_avg_us = c->samples != 0 ? c->latency_sum_us / c->samples : 0;
+	stats->latency_max_us = c->latency_max_us;
+
+	for (int i = 0; i < MB7040_PHASE_COUNT; i++) {
+		const struct mb7040_phase_counter *p = &c->phase[i];
+
+		stats->phase[i].min_us = p->min_ns / NSEC_PER_USEC;
+		stats->phase[i].avg_us = p->count != 0 ? p->sum_ns / p->count / NSEC_PER_USEC : 0;
+		stats->phase[i].max_us = p->max_ns / NSEC_PER_USEC;
+	}
+
+	return 0;
+}
+
+void mb7040_stats_reset(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+
+	memset(&data->counters, 0, sizeof(data->counters));
+}
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/logging/log.h>
+
+#include "mb7040.h"
+
+LOG_MODULE_DECLARE(mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+#define MB7040_RING_MASK (CONFIG_MB7040_STREAM_RING_DEPTH - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_MB7040_STREAM_RING_DEPTH),
+	     "CONFIG_MB7040_STREAM_RING_DEPTH must be a power of two");
+
+static void mb7040_stream_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct mb7040_stream *stream = CONTAINER_OF(dwork, struct mb7040_stream, work);
+	struct mb7040_data *data = CONTAINER_OF(stream, struct mb7040_data, stream);
+	int ret;
+
+	if (!atomic_get(&stream->enabled) || mb7040_is_suspended(data->dev)) {
+		/* Resuming the device restarts streaming */
+		return;
+	}
+
+	if (!atomic_cas(&data->state, MB7040_STATE_IDLE, MB7040_STATE_RANGING)) {
+		/* A one-shot cycle is still running, its completion retriggers us */
+		return;
+	}
+
+	ret = mb7040_range_start(data->dev);
+	if (ret != 0) {
+		mb7040_range_complete(data, ret);
+	}
+}
+
+/* Producer side, only ever runs from the read work item */
+void mb7040_stream_push(struct mb7040_data *data, int result)
+{
+	struct mb7040_stream *stream = &data->stream;
+	uint32_t head = (uint32_t)atomic_get(&stream->head);
+	uint32_t tail = (uint32_t)atomic_get(&stream->tail);
+	struct mb7040_sample *sample;
+
+	if (!atomic_get(&stream->enabled)) {
+		return;
+	}
+
+	if (head - tail >= CONFIG_MB7040_STREAM_RING_DEPTH) {
+		stream->dropped++;
+	} else {
+		sample = &stream->ring[head & MB7040_RING_MASK];
+		sample->status = 0;
+		if (result == 0) {
+			sample->timestamp_ns = data->timestamp_ns;
+			sample->distance_cm = data->distance_cm;
+		} else {
+			sample->timestamp_ns = mb7040_timestamp_ns();
+			sample->distance_cm = 0;
+			sample->status |= MB7040_SAMPLE_ERROR;
+		}
+		if (stream->dropped != 0) {
+			sample->status |= MB7040_SAMPLE_OVERRUN;
+			stream->dropped = 0;
+		}
+
+		/* Publish the slot only after it is filled in */
+		atomic_set(&stream->head, (atomic_val_t)(head + 1));
+	}
+
+	/* Back off on errors so a missing sensor doesn't hog the workqueue */
+	k_work_reschedule(&stream->work, result == 0 ? mb7040_next_cycle_delay(data, 0)
+						     : K_MSEC(CONFIG_MB7040_DELAY_MS));
+}
+
+int mb7040_stream_start(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_stream *stream = &data->stream;
+
+	if (!atomic_cas(&stream->enabled, 0, 1)) {
+		return -EALREADY;
+	}
+
+	k_work_reschedule(&stream->work, K_NO_WAIT);
+	LOG_DBG("%s: streaming started", dev->name);
+
+	return 0;
+}
+
+int mb7040_stream_stop(const struct device *dev)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_stream *stream = &data->stream;
+
+	if (!atomic_cas(&stream->enabled, 1, 0)) {
+		return -EALREADY;
+	}
+
+	k_work_cancel_delayable(&stream->work);
+#ifdef CONFIG_MB7040_TRIGGER
+	if (atomic_get(&data->trigger.armed)) {
+		/* Hand background ranging back to the threshold trigger */
+		k_work_reschedule(&data->trigger.work, K_NO_WAIT);
+	}
+#endif
+	LOG_DBG("%s: streaming stopped", dev->name);
+
+	return 0;
+}
+
+size_t mb7040_stream_read(const struct device *dev, struct mb7040_sample *buf, size_t max)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_stream *stream = &data->stream;
+	uint32_t head = (uint32_t)atomic_get(&stream->head);
+	uint32_t tail = (uint32_t)atomic_get(&stream->tail);
+	size_t count = 0;
+
+	while (tail != head && count < max) {
+		buf[count++] = stream->ring[tail & MB7040_RING_MASK];
+		tail++;
+	}
+
+	/* Hand the slots back to the producer */
+	atomic_set(&stream->tail, (atomic_val_t)tail);
+
+	return count;
+}
+
+void mb7040_stream_init(struct mb7040_data *data)
+{
+	k_work_init_delayable(&data->stream.work, mb7040_stream_work_handler);
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include <zephyr/logging/log.h>
+
+#include "mb7040.h"
+
+LOG_MODULE_DECLARE(mb7040, CONFIG_SENSOR_LOG_LEVEL);
+
+static void mb7040_trigger_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct mb7040_trigger *trigger = CONTAINER_OF(dwork, struct mb7040_trigger, work);
+	struct mb7040_data *data = CONTAINER_OF(trigger, struct mb7040_data, trigger);
+	int ret;
+
+	if (!atomic_get(&trigger->armed) || mb7040_is_streaming(data) ||
+	    mb7040_is_suspended(data->dev)) {
+		/* Disarmed, streaming is ranging anyway, or resuming restarts us */
+		return;
+	}
+
+	if (!atomic_cas(&data->state, MB7040_STATE_IDLE, MB7040_STATE_RANGING)) {
+		/* A one-shot cycle is still running, its completion retriggers us */
+		return;
+	}
+
+	ret = mb7040_range_start(data->dev);
+	if (ret != 0) {
+		mb7040_range_complete(data, ret);
+	}
+}
+
+/* Band the distance is in, with the hysteresis applied around the band it was in before */
+static enum mb7040_zone mb7040_trigger_zone(const struct mb7040_trigger *trigger,
+					    uint16_t distance_cm)
+{
+	switch (trigger->zone) {
+	case MB7040_ZONE_BELOW:
+		if (distance_cm < trigger->lower_cm + trigger->hyst_cm) {
+			return MB7040_ZONE_BELOW;
+		}
+		break;
+	case MB7040_ZONE_ABOVE:
+		if (distance_cm + trigger->hyst_cm > trigger->upper_cm) {
+			return MB7040_ZONE_ABOVE;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (distance_cm < trigger->lower_cm) {
+		return MB7040_ZONE_BELOW;
+	}
+	if (distance_cm > trigger->upper_cm) {
+		return MB7040_ZONE_ABOVE;
+	}
+
+	return MB7040_ZONE_INSIDE;
+}
+
+/* Runs from range_complete for every cycle, whoever started it */
+void mb7040_trigger_check(struct mb7040_data *data, int result)
+{
+	struct mb7040_trigger *trigger = &data->trigger;
+	enum mb7040_zone zone;
+	k_timeout_t delay;
+
+	if (!atomic_get(&trigger->armed)) {
+		return;
+	}
+
+	if (result == 0) {
+		zone = mb7040_trigger_zone(trigger, data->distance_cm);
+		if (zone != trigger->zone) {
+			trigger->zone = zone;
+			if (zone != MB7040_ZONE_INSIDE && trigger->handler != NULL) {
+				trigger->handler(data->dev, trigger->trig);
+			}
+		}
+	}
+
+	if (mb7040_is_streaming(data)) {
+		return;
+	}
+
+	if (result == 0) {
+		delay = mb7040_next_cycle_delay(data, CONFIG_MB7040_TRIGGER_PERIOD_MS * 1000U);
+	} else {
+		/* Back off on errors so a missing sensor doesn't hog the workqueue */
+		delay = K_MSEC(CONFIG_MB7040_DELAY_MS);
+	}
+	k_work_reschedule(&trigger->work, delay);
+}
+
+int mb7040_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+		       sensor_trigger_handler_t handler)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_trigger *trigger = &data->trigger;
+
+	if (trig->type != SENSOR_TRIG_THRESHOLD ||
+	    (trig->chan != SENSOR_CHAN_DISTANCE && trig->chan != SENSOR_CHAN_ALL)) {
+		LOG_ERR("Only distance threshold triggers are supported");
+		return -ENOTSUP;
+	}
+
+	if (handler == NULL) {
+		atomic_set(&trigger->armed, 0);
+		k_work_cancel_delayable(&trigger->work);
+		trigger->handler = NULL;
+		return 0;
+	}
+
+	atomic_set(&trigger->armed, 0);
+	k_work_cancel_delayable(&trigger->work);
+
+	trigger->handler = handler;
+	trigger->trig = trig;
+	/* A target already outside the band on the first sample is reported too */
+	trigger->zone = MB7040_ZONE_INSIDE;
+
+	atomic_set(&trigger->armed, 1);
+	k_work_reschedule(&trigger->work, K_NO_WAIT);
+
+	return 0;
+}
+
+int mb7040_trigger_attr_set(const struct device *dev, enum sensor_attribute attr,
+			    const struct sensor_value *val)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_trigger *trigger = &data->trigger;
+	int64_t cm;
+
+	/* Thresholds are in meters, same as the distance channel */
+	cm = (int64_t)val->val1 * 100 + val->val2 / 10000;
+	if (cm < 0 || cm > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	switch (attr) {
+	case SENSOR_ATTR_UPPER_THRESH:
+		trigger->upper_cm = cm;
+		break;
+	case SENSOR_ATTR_LOWER_THRESH:
+		trigger->lower_cm = cm;
+		break;
+	case SENSOR_ATTR_HYSTERESIS:
+		trigger->hyst_cm = cm;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+int mb7040_trigger_attr_get(const struct device *dev, enum sensor_attribute attr,
+			    struct sensor_value *val)
+{
+	struct mb7040_data *data = (struct mb7040_data *)dev->data;
+	struct mb7040_trigger *trigger = &data->trigger;
+	uint16_t cm;
+
+	switch (attr) {
+	case SENSOR_ATTR_UPPER_THRESH:
+		cm = trigger->upper_cm;
+		break;
+	case SENSOR_ATTR_LOWER_THRESH:
+		cm = trigger->lower_cm;
+		break;
+	case SENSOR_ATTR_HYSTERESIS:
+		cm = trigger->hyst_cm;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	val->val1 = cm / 100;
+	val->val2 = (cm % 100) * 10000;
+
+	return 0;
+}
+
+void mb7040_trigger_init(struct mb7040_data *data)
+{
+	data->trigger.upper_cm = UINT16_MAX;
+	data->trigger.lower_cm = 0;
+	data->trigger.hyst_cm = 0;
+	k_work_init_delayable(&data->trigger.work, mb7040_trigger_work_handler);
+}
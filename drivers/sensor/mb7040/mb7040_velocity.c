@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT maxbotix_mb7040
+
+#include "mb7040.h"
+
+#ifdef CONFIG_MB7040_DUTY_CYCLE
+/* A fully stretched duty cycle is a regular gap, not a lost target */
+#define MB7040_VELOCITY_RESET_MS (CONFIG_MB7040_DUTY_CYCLE_MAX_MS + CONFIG_MB7040_VELOCITY_RESET_MS)
+#else
+#define MB7040_VELOCITY_RESET_MS CONFIG_MB7040_VELOCITY_RESET_MS
+#endif
+
+#define MB7040_VELOCITY_RESET_NS ((uint64_t)MB7040_VELOCITY_RESET_MS * NSEC_PER_MSEC)
+
+/*
+ * Alpha-beta filter on the timestamped samples. Position is kept in micrometers and velocity in
+ * micrometers per second so a 1 cm step at the default gains still moves both by a useful
+ * amount, alpha and beta are in thousandths.
+ */
+void mb7040_velocity_update(struct mb7040_velocity *vf, uint16_t distance_cm,
+			    uint64_t timestamp_ns)
+{
+	int64_t z_um = (int64_t)distance_cm * 10000;
+	int64_t dt_us;
+	int64_t x_pred;
+	int64_t residual;
+
+	if (!vf->valid || timestamp_ns <= vf->last_ns ||
+	    timestamp_ns - vf->last_ns > MB7040_VELOCITY_RESET_NS) {
+		/* First sample or the target was lost for a while, restart from rest */
+		vf->x_um = z_um;
+		vf->v_ums = 0;
+		vf->last_ns = timestamp_ns;
+		vf->valid = true;
+		return;
+	}
+
+	dt_us = (timestamp_ns - vf->last_ns) / NSEC_PER_USEC;
+	if (dt_us == 0) {
+		return;
+	}
+
+	x_pred = vf->x_um + vf->v_ums * dt_us / USEC_PER_SEC;
+	residual = z_um - x_pred;
+
+	vf->x_um = x_pred + residual * CONFIG_MB7040_VELOCITY_ALPHA / 1000;
+	vf->v_ums += residual * CONFIG_MB7040_VELOCITY_BETA * (USEC_PER_SEC / 1000) / dt_us;
+	vf->last_ns = timestamp_ns;
+}
+
+void mb7040_velocity_get(const struct mb7040_velocity *vf, struct sensor_value *val)
+{
+	int64_t v_ums = vf->valid ? vf->v_ums : 0;
+
+	/* cm/s, both parts carry the sign like sensor_value_from_micro() */
+	val->val1 = (int32_t)(v_ums / 10000);
+	val->val2 = (int32_t)(v_ums % 10000) * 100;
+}
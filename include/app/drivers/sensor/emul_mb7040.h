@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Backend API of the MB7040 I2C emulator
+ */
+
+#ifndef APP_INCLUDE_APP_DRIVERS_SENSOR_EMUL_MB7040_H_
+#define APP_INCLUDE_APP_DRIVERS_SENSOR_EMUL_MB7040_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/emul.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief One point of a scripted distance waveform */
+struct mb7040_emul_point {
+	/** Time since mb7040_emul_set_waveform() in milliseconds */
+	uint32_t time_ms;
+	/** Distance at that time in centimeters */
+	uint16_t distance_cm;
+};
+
+/**
+ * @brief Set a constant distance for the emulated sensor to measure
+ *
+ * Replaces any waveform set before.
+ *
+ * @param target MB7040 emulator
+ * @param distance_cm Distance in centimeters
+ */
+void mb7040_emul_set_distance(const struct emul *target, uint16_t distance_cm);
+
+/**
+ * @brief Script the measured distance over time
+ *
+ * The distance is linearly interpolated between points, which must be sorted
+ * by time. Each range command latches the distance at the time it is received.
+ *
+ * @param target MB7040 emulator
+ * @param points Waveform points, must stay valid while in use
+ * @param count Number of points
+ * @param repeat Restart from the first point after the last one
+ */
+void mb7040_emul_set_waveform(const struct emul *target, const struct mb7040_emul_point *points,
+			      size_t count, bool repeat);
+
+/**
+ * @brief NACK every transfer, as if the sensor was disconnected
+ *
+ * @param target MB7040 emulator
+ * @param nack true to NACK all transfers, false for normal operation
+ */
+void mb7040_emul_set_nack(const struct emul *target, bool nack);
+
+/**
+ * @brief Make range cycles never finish
+ *
+ * While set, a range command keeps the status GPIO high and the sensor busy
+ * forever. Clearing it ends a hung cycle right away.
+ *
+ * @param target MB7040 emulator
+ * @param stuck true to hang range cycles, false for normal operation
+ */
+void mb7040_emul_set_stuck(const struct emul *target, bool stuck);
+
+/**
+ * @brief Bytes transferred with the emulated sensor, address bytes included
+ *
+ * @param target MB7040 emulator
+ */
+uint32_t mb7040_emul_get_bus_bytes(const struct emul *target);
+
+/**
+ * @brief Number of range commands the emulated sensor received
+ *
+ * @param target MB7040 emulator
+ */
+uint32_t mb7040_emul_get_range_count(const struct emul *target);
+
+/**
+ * @brief Number of transfers the emulated sensor NACKed because it was ranging
+ *
+ * @param target MB7040 emulator
+ */
+uint32_t mb7040_emul_get_nack_count(const struct emul *target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_INCLUDE_APP_DRIVERS_SENSOR_EMUL_MB7040_H_ */
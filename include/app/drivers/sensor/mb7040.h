@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 Sabrina Simkhovich <sabrinasimkhovich@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Extended API of the MB7040 ultrasonic distance sensor driver
+ */
+
+#ifndef APP_INCLUDE_APP_DRIVERS_SENSOR_MB7040_H_
+#define APP_INCLUDE_APP_DRIVERS_SENSOR_MB7040_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief MB7040 specific channels */
+enum sensor_channel_mb7040 {
+	/**
+	 * Time the last sample's echo completed, in seconds (val1) and
+	 * microseconds (val2) since boot. With a status GPIO this is the falling
+	 * edge captured in the interrupt. Without one it is only the time the
+	 * read work item ran, after the read delay and any scheduling latency.
+	 * The resolution is that of the 64-bit cycle counter where the timer
+	 * has one (CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER), otherwise the system
+	 * tick, so val2 may move in whole ticks.
+	 */
+	SENSOR_CHAN_MB7040_TIMESTAMP = SENSOR_CHAN_PRIV_START,
+	/**
+	 * Radial velocity of the target in cm/s, positive while it moves away
+	 * and negative while it approaches. Estimated by an alpha-beta filter
+	 * over the sample timestamps, requires CONFIG_MB7040_VELOCITY.
+	 */
+	SENSOR_CHAN_MB7040_VELOCITY,
+};
+
+/** @brief MB7040 specific attributes */
+enum sensor_attribute_mb7040 {
+	/**
+	 * Largest distance reported on the distance channel, in meters.
+	 * Farther readings are reported as this distance. The sensor always
+	 * ranges its full cycle, so this does not shorten it.
+	 */
+	SENSOR_ATTR_MB7040_MAX_RANGE = SENSOR_ATTR_PRIV_START,
+	/**
+	 * Time from the range command to the read without a status GPIO, or
+	 * the status GPIO timeout with one, in seconds. Rounded up to whole
+	 * milliseconds, defaults to CONFIG_MB7040_DELAY_MS.
+	 */
+	SENSOR_ATTR_MB7040_READ_DELAY,
+};
+
+/** The range cycle failed, distance_cm is not valid */
+#define MB7040_SAMPLE_ERROR   BIT(0)
+/** Samples were dropped before this one because the ring was full */
+#define MB7040_SAMPLE_OVERRUN BIT(1)
+
+/** @brief One timestamped MB7040 measurement */
+struct mb7040_sample {
+	/**
+	 * Time in nanoseconds since boot at which the echo completed, see
+	 * SENSOR_CHAN_MB7040_TIMESTAMP for its accuracy and resolution
+	 */
+	uint64_t timestamp_ns;
+	/** Measured distance in centimeters */
+	uint16_t distance_cm;
+	/** MB7040_SAMPLE_* flags */
+	uint16_t status;
+};
+
+/**
+ * @brief Start continuous ranging
+ *
+ * The driver retriggers ranging back-to-back, or at the rate set with
+ * SENSOR_ATTR_SAMPLING_FREQUENCY if any, and queues every result in a
+ * ring of CONFIG_MB7040_STREAM_RING_DEPTH samples. While streaming,
+ * sensor_sample_fetch() does not start a new cycle and sensor_channel_get()
+ * returns the latest result.
+ *
+ * @param dev MB7040 device
+ *
+ * @retval 0 on success
+ * @retval -EALREADY if already streaming
+ */
+int mb7040_stream_start(const struct device *dev);
+
+/**
+ * @brief Stop continuous ranging
+ *
+ * A range cycle already in progress still completes and updates the value
+ * returned by sensor_channel_get(), but is not queued.
+ *
+ * @param dev MB7040 device
+ *
+ * @retval 0 on success
+ * @retval -EALREADY if not streaming
+ */
+int mb7040_stream_stop(const struct device *dev);
+
+/**
+ * @brief Drain queued samples
+ *
+ * Must only be called from one thread at a time per device.
+ *
+ * @param dev MB7040 device
+ * @param buf Destination for the samples, oldest first
+ * @param max Capacity of @p buf in samples
+ *
+ * @return Number of samples copied to @p buf
+ */
+size_t mb7040_stream_read(const struct device *dev, struct mb7040_sample *buf, size_t max);
+
+/**
+ * @brief Take several samples back to back in the calling thread
+ *
+ * Reading sample k and sending the range command for sample k+1 share one
+ * I2C transaction, so a burst of @p n samples costs n + 1 transactions
+ * instead of 2n. The call blocks for the whole burst. With
+ * CONFIG_MB7040_BUS_SCHEDULER the burst holds the bus for its duration, so
+ * no other firing group ranges alongside it.
+ *
+ * @param dev MB7040 device
+ * @param buf Destination for the samples
+ * @param n Number of samples to take
+ *
+ * @return Number of samples stored in @p buf, which is less than @p n if a
+ *         cycle failed part way, or a negative error code if none were taken
+ * @retval -EBUSY if a range cycle or streaming is in progress, or another
+ *         firing group on the bus is ranging
+ */
+int mb7040_fetch_burst(const struct device *dev, struct mb7040_sample *buf, size_t n);
+
+/** @brief Phases of a range cycle */
+enum mb7040_phase {
+	/** I2C write of the range command */
+	MB7040_PHASE_WRITE,
+	/**
+	 * Ranging, until the status GPIO drops or, without one, until the
+	 * read that returns the result starts
+	 */
+	MB7040_PHASE_WAIT,
+	/** Settle time and workqueue latency after the status GPIO dropped */
+	MB7040_PHASE_SETTLE,
+	/** I2C read of the result */
+	MB7040_PHASE_READ,
+	/** Number of phases */
+	MB7040_PHASE_COUNT,
+};
+
+/** @brief Duration of one phase over successful cycles, in microseconds */
+struct mb7040_phase_stats {
+	/** Shortest */
+	uint32_t min_us;
+	/** Average */
+	uint32_t avg_us;
+	/** Longest */
+	uint32_t max_us;
+};
+
+/** @brief Per instance driver counters */
+struct mb7040_stats {
+	/** Range cycles run, failed ones and burst samples included */
+	uint32_t fetches;
+	/** Failed cycles, timeouts and I2C errors included */
+	uint32_t errors;
+	/** Cycles whose status GPIO edge never came */
+	uint32_t timeouts;
+	/** Failed I2C transfers */
+	uint32_t i2c_errors;
+	/** Average time from range command to sample in microseconds */
+	uint32_t latency_avg_us;
+	/** Longest time from range command to sample in microseconds */
+	uint32_t latency_max_us;
+	/**
+	 * Per phase durations, all zero for phases a cycle does not have, e.g.
+	 * MB7040_PHASE_SETTLE without a status GPIO. Burst samples after the
+	 * first send their range command within the previous read, so they
+	 * have no write phase of their own.
+	 */
+	struct mb7040_phase_stats phase[MB7040_PHASE_COUNT];
+};
+
+/**
+ * @brief Read the driver counters
+ *
+ * The counters are updated without locking, a read racing a range cycle
+ * may mix values from before and after it. Requires CONFIG_MB7040_STATS.
+ *
+ * @param dev MB7040 device
+ * @param stats Destination for the counters
+ *
+ * @retval 0 on success
+ */
+int mb7040_stats_get(const struct device *dev, struct mb7040_stats *stats);
+
+/**
+ * @brief Zero the driver counters
+ *
+ * @param dev MB7040 device
+ */
+void mb7040_stats_reset(const struct device *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_INCLUDE_APP_DRIVERS_SENSOR_MB7040_H_ */